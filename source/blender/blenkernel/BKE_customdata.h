@@ -295,6 +295,13 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+void CustomData_interp_n(const struct CustomData *source,
+                         struct CustomData *dest,
+                         const int *src_indices,
+                         const float *weights,
+                         int count,
+                         int dest_index,
+                         int dest_num);
 void CustomData_bmesh_interp_n(struct CustomData *data,
                                const void **src_blocks,
                                const float *weights,
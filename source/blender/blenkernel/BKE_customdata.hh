@@ -0,0 +1,57 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Typed access to custom data layers. Every layer stores its elements in a separate array, so
+ * code that only needs a single attribute (e.g. positions in a #CD_PROP_FLOAT3 layer) can stream
+ * over it as a span, without loading the other attributes of the same elements.
+ */
+
+#include "BLI_span.hh"
+
+#include "BKE_customdata.h"
+
+namespace blender::fn {
+class CPPType;
+}
+
+namespace blender::bke {
+
+const fn::CPPType *custom_data_type_to_cpp_type(const CustomDataType type);
+CustomDataType cpp_type_to_custom_data_type(const fn::CPPType &type);
+
+/**
+ * The active layer of the given type, or an empty span when there is none.
+ * The element type has to match the size of the layer type.
+ */
+template<typename T>
+Span<T> custom_data_layer_span(const CustomData &data,
+                               const CustomDataType type,
+                               const int64_t size)
+{
+  BLI_assert(CustomData_sizeof(type) == sizeof(T));
+  const T *layer_data = static_cast<const T *>(CustomData_get_layer(&data, type));
+  if (layer_data == nullptr) {
+    return {};
+  }
+  return Span<T>(layer_data, size);
+}
+
+}  // namespace blender::bke
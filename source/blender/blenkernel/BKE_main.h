@@ -161,6 +161,12 @@ typedef struct Main {
    */
   struct MainIDRelations *relations;
 
+  /**
+   * Name lookup map of the IDs in this Main, used by the blend-file reader while linking
+   * to find IDs that were already read. Only valid while reading, see `readfile.c`.
+   */
+  struct IDNameLib_Map *id_map;
+
   struct MainLock *lock;
 } Main;
 
@@ -57,6 +57,7 @@ struct ID *BKE_main_idmap_lookup_name(struct IDNameLib_Map *id_typemap,
                                       const char *name,
                                       const struct Library *lib) ATTR_WARN_UNUSED_RESULT
     ATTR_NONNULL(1, 3);
+void BKE_main_idmap_insert_id(struct IDNameLib_Map *id_map, struct ID *id) ATTR_NONNULL();
 struct ID *BKE_main_idmap_lookup_id(struct IDNameLib_Map *id_typemap,
                                     const struct ID *id) ATTR_WARN_UNUSED_RESULT
     ATTR_NONNULL(1, 2);
@@ -0,0 +1,82 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Cache of the meshes generated by constructive modifiers, so the modifier stack can be
+ * evaluated starting from the first modifier whose input or settings changed.
+ *
+ * Every result is stored with a key that is chained over the stack: the key of the input mesh
+ * is a hash of its data, and every modifier combines the key of its input with a hash of its
+ * settings. A matching key therefore means that neither the input nor any of the preceding
+ * modifiers changed. Modifiers which depend on data outside of the mesh (other IDs, time,
+ * point caches, ...) can't be part of the chain, see #BKE_mesh_modifier_cache_supported.
+ *
+ * The cache is shared by all objects and limited to #MESH_MODIFIER_CACHE_BUDGET bytes, the least
+ * recently used results are freed first. A result is only stored once its key repeated, and all
+ * results are freed when loading a file or undo.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct CustomData_MeshMasks;
+struct Mesh;
+struct ModifierData;
+struct Object;
+struct Scene;
+
+/** Memory used by the meshes stored in the cache. */
+#define MESH_MODIFIER_CACHE_BUDGET ((size_t)256 << 20)
+
+/** Number of evaluations in a row with the same key before the result is stored. */
+#define MESH_MODIFIER_CACHE_STORE_REPEAT 2
+
+/** Key that is never stored, to mark that the stack can't be cached from this point on. */
+#define MESH_MODIFIER_CACHE_KEY_NONE 0
+
+uint64_t BKE_mesh_modifier_cache_key_init(const struct Scene *scene,
+                                          const struct Object *ob,
+                                          struct Mesh *mesh,
+                                          const float (*deformed_verts)[3],
+                                          const int num_deformed_verts,
+                                          const int apply_flag,
+                                          const bool need_mapping);
+uint64_t BKE_mesh_modifier_cache_key_next(const uint64_t key,
+                                          const struct ModifierData *md,
+                                          const struct CustomData_MeshMasks *mask,
+                                          const struct CustomData_MeshMasks *next_mask);
+
+bool BKE_mesh_modifier_cache_supported(struct ModifierData *md, struct Object *ob);
+
+bool BKE_mesh_modifier_cache_contains(const struct ModifierData *md, const uint64_t key);
+struct Mesh *BKE_mesh_modifier_cache_lookup(const struct ModifierData *md, const uint64_t key);
+void BKE_mesh_modifier_cache_store(const struct ModifierData *md,
+                                   const uint64_t key,
+                                   const struct Mesh *mesh);
+
+void BKE_mesh_modifier_cache_clear(void);
+void BKE_mesh_modifier_cache_exit(void);
+
+#ifdef __cplusplus
+}
+#endif
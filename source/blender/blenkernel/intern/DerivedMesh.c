@@ -55,6 +55,7 @@
 #include "BKE_mesh.h"
 #include "BKE_mesh_iterators.h"
 #include "BKE_mesh_mapping.h"
+#include "BKE_mesh_modifier_cache.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_mesh_tangent.h"
 #include "BKE_mesh_wrapper.h"
@@ -869,6 +870,109 @@ void BKE_mesh_wrapper_deferred_finalize(Mesh *me_eval,
   BLI_assert(me_eval->runtime.wrapper_type_finalize == 0);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Modifier Result Cache
+ * \{ */
+
+/**
+ * The cache is only used for the common evaluation, special modes pass extra data along the
+ * stack which isn't cached. Hashing the input mesh is avoided when the first modifier can't be
+ * cached anyway.
+ *
+ * The preview modifier doesn't need to be checked: every constructive modifier counts as one in
+ * object mode, and the preview data it requests is part of the data masks that are hashed.
+ */
+static bool mesh_modifier_cache_is_used(Scene *scene,
+                                        Object *ob,
+                                        ModifierData *md,
+                                        const CDMaskLink *datamasks,
+                                        const CustomData_MeshMasks *final_datamask,
+                                        const int required_mode,
+                                        const int index,
+                                        const bool sculpt_mode)
+{
+  if (index != -1 || sculpt_mode) {
+    return false;
+  }
+  while (md && !BKE_modifier_is_enabled(scene, md, required_mode)) {
+    md = md->next;
+  }
+  if (md == NULL || !BKE_mesh_modifier_cache_supported(md, ob)) {
+    return false;
+  }
+  /* Orco meshes are evaluated by the constructive modifiers along with the final mesh. */
+  const uint64_t orco_mask = CD_MASK_ORCO | CD_MASK_CLOTH_ORCO;
+  if (final_datamask->vmask & orco_mask) {
+    return false;
+  }
+  for (const CDMaskLink *link = datamasks; link; link = link->next) {
+    if (link->mask.vmask & orco_mask) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Find the last constructive modifier with a cached result for \a key, the key of the mesh passed
+ * to \a md. This skips modifiers the same way as #mesh_calc_modifiers and stops at the first
+ * modifier that can't be cached.
+ */
+static ModifierData *mesh_modifier_cache_find_resume(Scene *scene,
+                                                     Object *ob,
+                                                     ModifierData *md,
+                                                     CDMaskLink *md_datamask,
+                                                     const CustomData_MeshMasks *final_datamask,
+                                                     const int required_mode,
+                                                     const int useDeform,
+                                                     const bool need_mapping,
+                                                     uint64_t key,
+                                                     CDMaskLink **r_md_datamask,
+                                                     uint64_t *r_key)
+{
+  ModifierData *md_resume = NULL;
+  bool have_non_onlydeform = false;
+
+  for (; md; md = md->next, md_datamask = md_datamask->next) {
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+
+    if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
+      continue;
+    }
+    if (mti->type == eModifierTypeType_OnlyDeform && !useDeform) {
+      continue;
+    }
+    if ((mti->flags & eModifierTypeFlag_RequiresOriginalData) && have_non_onlydeform) {
+      break;
+    }
+    if (need_mapping && !BKE_modifier_supports_mapping(md)) {
+      continue;
+    }
+    if (useDeform < 0 && mti->dependsOnTime && mti->dependsOnTime(md)) {
+      continue;
+    }
+    if (!BKE_mesh_modifier_cache_supported(md, ob)) {
+      break;
+    }
+
+    const CustomData_MeshMasks *next_mask = md_datamask->next ? &md_datamask->next->mask :
+                                                                final_datamask;
+    key = BKE_mesh_modifier_cache_key_next(key, md, &md_datamask->mask, next_mask);
+
+    if (mti->type != eModifierTypeType_OnlyDeform) {
+      have_non_onlydeform = true;
+      if (BKE_mesh_modifier_cache_contains(md, key)) {
+        md_resume = md;
+        *r_md_datamask = md_datamask;
+        *r_key = key;
+      }
+    }
+  }
+  return md_resume;
+}
+
+/** \} */
+
 static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
                                 Scene *scene,
                                 Object *ob,
@@ -1009,6 +1113,57 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
 
   /* Apply all remaining constructive and deforming modifiers. */
   bool have_non_onlydeform_modifiers_appled = false;
+
+  /* Key of the mesh passed to the current modifier, see BKE_mesh_modifier_cache.h. */
+  uint64_t cache_key = MESH_MODIFIER_CACHE_KEY_NONE;
+  if (mesh_modifier_cache_is_used(scene,
+                                  ob,
+                                  md,
+                                  datamasks,
+                                  &final_datamask,
+                                  required_mode,
+                                  index,
+                                  sculpt_mode)) {
+    cache_key = BKE_mesh_modifier_cache_key_init(scene,
+                                                 ob,
+                                                 mesh_input,
+                                                 (const float(*)[3])deformed_verts,
+                                                 num_deformed_verts,
+                                                 mectx.flag,
+                                                 need_mapping);
+  }
+
+  /* Continue after the last modifier whose result didn't change since the previous evaluation. */
+  if (cache_key != MESH_MODIFIER_CACHE_KEY_NONE) {
+    CDMaskLink *md_datamask_resume;
+    uint64_t cache_key_resume;
+    ModifierData *md_resume = mesh_modifier_cache_find_resume(scene,
+                                                              ob,
+                                                              md,
+                                                              md_datamask,
+                                                              &final_datamask,
+                                                              required_mode,
+                                                              useDeform,
+                                                              need_mapping,
+                                                              cache_key,
+                                                              &md_datamask_resume,
+                                                              &cache_key_resume);
+    Mesh *mesh_cached = md_resume ? BKE_mesh_modifier_cache_lookup(md_resume, cache_key_resume) :
+                                    NULL;
+    if (mesh_cached) {
+      if (mesh_final) {
+        BKE_id_free(NULL, mesh_final);
+      }
+      mesh_final = mesh_cached;
+      MEM_SAFE_FREE(deformed_verts);
+      have_non_onlydeform_modifiers_appled = true;
+      isPrevDeform = false;
+      md = md_resume->next;
+      md_datamask = md_datamask_resume->next;
+      cache_key = cache_key_resume;
+    }
+  }
+
   for (; md; md = md->next, md_datamask = md_datamask->next) {
     const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
 
@@ -1023,6 +1178,7 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
     if ((mti->flags & eModifierTypeFlag_RequiresOriginalData) &&
         have_non_onlydeform_modifiers_appled) {
       BKE_modifier_set_error(md, "Modifier requires original data, bad stack position");
+      cache_key = MESH_MODIFIER_CACHE_KEY_NONE;
       continue;
     }
 
@@ -1066,6 +1222,18 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       continue;
     }
 
+    if (cache_key != MESH_MODIFIER_CACHE_KEY_NONE) {
+      if (BKE_mesh_modifier_cache_supported(md, ob)) {
+        const CustomData_MeshMasks *next_mask = md_datamask->next ? &md_datamask->next->mask :
+                                                                    &final_datamask;
+        cache_key = BKE_mesh_modifier_cache_key_next(
+            cache_key, md, &md_datamask->mask, next_mask);
+      }
+      else {
+        cache_key = MESH_MODIFIER_CACHE_KEY_NONE;
+      }
+    }
+
     /* Add orco mesh as layer if needed by this modifier. */
     if (mesh_final && mesh_orco && mti->requiredDataMask) {
       CustomData_MeshMasks mask = {0};
@@ -1265,6 +1433,15 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       }
 
       mesh_final->runtime.deformed_only = false;
+
+      if (cache_key != MESH_MODIFIER_CACHE_KEY_NONE && md->error == NULL) {
+        BKE_mesh_modifier_cache_store(md, cache_key, mesh_final);
+      }
+    }
+
+    /* Errors are only set when the modifier is evaluated, so it must not be skipped later. */
+    if (md->error != NULL) {
+      cache_key = MESH_MODIFIER_CACHE_KEY_NONE;
     }
 
     isPrevDeform = (mti->type == eModifierTypeType_OnlyDeform);
@@ -1755,6 +1932,71 @@ static void mesh_runtime_check_normals_valid(const Mesh *mesh)
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+/**
+ * Detach the previous evaluated mesh from the object when its draw cache may be reused by the
+ * next evaluation, see #mesh_build_data_batch_cache_reuse. This is the case when it was only
+ * deformed from an input mesh that wasn't changed since, as is typical for animated characters.
+ */
+static Mesh *mesh_build_data_deformed_detach(Object *ob,
+                                             const CustomData_MeshMasks *dataMask,
+                                             const bool need_mapping)
+{
+  Mesh *mesh_eval = (Mesh *)ob->runtime.data_eval;
+  if (mesh_eval == NULL || !ob->runtime.is_data_eval_owned) {
+    return NULL;
+  }
+  if (mesh_eval->runtime.batch_cache == NULL || !mesh_eval->runtime.deformed_only ||
+      mesh_eval->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA ||
+      mesh_eval->runtime.subdiv_ccg != NULL || mesh_eval->edit_mesh != NULL) {
+    return NULL;
+  }
+  if (need_mapping != ob->runtime.last_need_mapping ||
+      !CustomData_MeshMasks_are_matching(&ob->runtime.last_data_mask, dataMask) ||
+      !CustomData_MeshMasks_are_matching(dataMask, &ob->runtime.last_data_mask)) {
+    return NULL;
+  }
+  /* The copy-on-write update of the input mesh replaces all of its data. */
+  const ID *mesh_input = ob->runtime.data_orig;
+  if (mesh_input == NULL || (mesh_input->recalc & ID_RECALC_COPY_ON_WRITE)) {
+    return NULL;
+  }
+
+  ob->runtime.data_eval = NULL;
+  return mesh_eval;
+}
+
+/**
+ * Move the draw cache of the previous evaluated mesh to the new one when both were only deformed
+ * from the same input mesh. They share the topology and all other data layers by reference, so
+ * only the buffers depending on vertex positions have to be updated, see
+ * #BKE_MESH_BATCH_DIRTY_DEFORM.
+ */
+static void mesh_build_data_batch_cache_reuse(Mesh *mesh_eval_prev,
+                                              Mesh *mesh_eval,
+                                              const bool is_mesh_eval_owned)
+{
+  if (!is_mesh_eval_owned || !mesh_eval->runtime.deformed_only ||
+      mesh_eval->runtime.batch_cache != NULL ||
+      mesh_eval->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return;
+  }
+  if (mesh_eval->totvert != mesh_eval_prev->totvert ||
+      mesh_eval->totedge != mesh_eval_prev->totedge ||
+      mesh_eval->totloop != mesh_eval_prev->totloop ||
+      mesh_eval->totpoly != mesh_eval_prev->totpoly ||
+      mesh_eval->totcol != mesh_eval_prev->totcol) {
+    return;
+  }
+  if (mesh_eval->medge != mesh_eval_prev->medge || mesh_eval->mloop != mesh_eval_prev->mloop ||
+      mesh_eval->mpoly != mesh_eval_prev->mpoly) {
+    return;
+  }
+
+  mesh_eval->runtime.batch_cache = mesh_eval_prev->runtime.batch_cache;
+  mesh_eval->runtime.batch_cache_deform_only = true;
+  mesh_eval_prev->runtime.batch_cache = NULL;
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1767,6 +2009,8 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  Mesh *mesh_eval_prev = mesh_build_data_deformed_detach(ob, dataMask, need_mapping);
+
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1804,6 +2048,11 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  if (mesh_eval_prev != NULL) {
+    mesh_build_data_batch_cache_reuse(mesh_eval_prev, mesh_eval, is_mesh_eval_owned);
+    BKE_mesh_eval_delete(mesh_eval_prev);
+  }
+
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
   ob->runtime.last_need_mapping = need_mapping;
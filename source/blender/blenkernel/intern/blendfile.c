@@ -52,6 +52,7 @@
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
+#include "BKE_mesh_modifier_cache.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -169,6 +170,9 @@ static void setup_app_data(bContext *C,
     RE_FreeAllRenderResults();
   }
 
+  /* The cached modifier results belong to the modifiers which are replaced now. */
+  BKE_mesh_modifier_cache_clear();
+
   /* Only make filepaths compatible when loading for real (not undo) */
   if (mode != LOAD_UNDO) {
     clean_paths(bfd->main);
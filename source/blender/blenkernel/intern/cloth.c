@@ -287,7 +287,7 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
         }
       }
 
-      BLI_bvhtree_update_tree(bvhtree);
+      BLI_bvhtree_update_tree_ex(bvhtree, BVH_UPDATE_REBUILD_DEGENERATE);
     }
   }
   else {
@@ -305,7 +305,7 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
         }
       }
 
-      BLI_bvhtree_update_tree(bvhtree);
+      BLI_bvhtree_update_tree_ex(bvhtree, BVH_UPDATE_REBUILD_DEGENERATE);
     }
   }
 }
@@ -183,7 +183,7 @@ void bvhtree_update_from_mvert(BVHTree *bvhtree,
     }
   }
 
-  BLI_bvhtree_update_tree(bvhtree);
+  BLI_bvhtree_update_tree_ex(bvhtree, BVH_UPDATE_REBUILD_DEGENERATE);
 }
 
 /* ***************************
@@ -3133,19 +3133,71 @@ void CustomData_free_elem(CustomData *data, int index, int count)
 
 #define SOURCE_BUF_SIZE 100
 
-void CustomData_interp(const CustomData *source,
-                       CustomData *dest,
-                       const int *src_indices,
-                       const float *weights,
-                       const float *sub_weights,
-                       int count,
-                       int dest_index)
+/**
+ * Number of floats in an element of layer types which are interpolated as a plain weighted sum,
+ * zero for types that need their own interpolation callback.
+ */
+static int layerType_interp_float_num(const int type)
+{
+  switch (type) {
+    case CD_PROP_FLOAT2:
+      return 2;
+    case CD_PROP_FLOAT3:
+      return 3;
+    case CD_PROP_COLOR:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Weighted sum over a whole layer, one destination element after another. Using a constant
+ * number of floats lets the compiler unroll the inner loop for every type.
+ */
+BLI_INLINE void customdata_interp_floats_n(const float *src_data,
+                                           float *dest_data,
+                                           const int float_num,
+                                           const int *src_indices,
+                                           const float *weights,
+                                           const float *sub_weights,
+                                           const int count,
+                                           const int dest_num)
+{
+  for (int dest_i = 0; dest_i < dest_num; dest_i++) {
+    const int offset = dest_i * count;
+    float result[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int j = 0; j < count; j++) {
+      const float *src = &src_data[(size_t)src_indices[offset + j] * float_num];
+      float weight = weights ? weights[offset + j] : 1.0f;
+      if (sub_weights) {
+        weight = sub_weights[offset + j] * weight;
+      }
+      for (int k = 0; k < float_num; k++) {
+        result[k] += src[k] * weight;
+      }
+    }
+    memcpy(&dest_data[(size_t)dest_i * float_num], result, sizeof(float) * float_num);
+  }
+}
+
+static void customdata_interp_ex(const CustomData *source,
+                                 CustomData *dest,
+                                 const int *src_indices,
+                                 const float *weights,
+                                 const float *sub_weights,
+                                 int count,
+                                 int dest_index,
+                                 int dest_num)
 {
   int src_i, dest_i;
   int j;
   const void *source_buf[SOURCE_BUF_SIZE];
   const void **sources = source_buf;
 
+  /* Sub-weights depend on the layer type, only a single element is supported. */
+  BLI_assert(sub_weights == NULL || dest_num == 1);
+
   /* Slow fallback in case we're interpolating a ridiculous number of elements. */
   if (count > SOURCE_BUF_SIZE) {
     sources = MEM_malloc_arrayN(count, sizeof(*sources), __func__);
@@ -3174,18 +3226,39 @@ void CustomData_interp(const CustomData *source,
     /* if we found a matching layer, copy the data */
     if (dest->layers[dest_i].type == source->layers[src_i].type) {
       void *src_data = source->layers[src_i].data;
+      void *dest_data = POINTER_OFFSET(dest->layers[dest_i].data,
+                                       (size_t)dest_index * typeInfo->size);
 
-      for (j = 0; j < count; j++) {
-        sources[j] = POINTER_OFFSET(src_data, (size_t)src_indices[j] * typeInfo->size);
+      switch (layerType_interp_float_num(source->layers[src_i].type)) {
+        case 2:
+          customdata_interp_floats_n(
+              src_data, dest_data, 2, src_indices, weights, sub_weights, count, dest_num);
+          break;
+        case 3:
+          customdata_interp_floats_n(
+              src_data, dest_data, 3, src_indices, weights, sub_weights, count, dest_num);
+          break;
+        case 4:
+          customdata_interp_floats_n(
+              src_data, dest_data, 4, src_indices, weights, sub_weights, count, dest_num);
+          break;
+        default:
+          for (int dest_elem = 0; dest_elem < dest_num; dest_elem++) {
+            const int offset = dest_elem * count;
+            for (j = 0; j < count; j++) {
+              sources[j] = POINTER_OFFSET(src_data,
+                                          (size_t)src_indices[offset + j] * typeInfo->size);
+            }
+
+            typeInfo->interp(sources,
+                             weights ? &weights[offset] : NULL,
+                             sub_weights,
+                             count,
+                             POINTER_OFFSET(dest_data, (size_t)dest_elem * typeInfo->size));
+          }
+          break;
       }
 
-      typeInfo->interp(
-          sources,
-          weights,
-          sub_weights,
-          count,
-          POINTER_OFFSET(dest->layers[dest_i].data, (size_t)dest_index * typeInfo->size));
-
       /* if there are multiple source & dest layers of the same type,
        * we don't want to copy all source layers to the same dest, so
        * increment dest_i
@@ -3199,6 +3272,35 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+void CustomData_interp(const CustomData *source,
+                       CustomData *dest,
+                       const int *src_indices,
+                       const float *weights,
+                       const float *sub_weights,
+                       int count,
+                       int dest_index)
+{
+  customdata_interp_ex(source, dest, src_indices, weights, sub_weights, count, dest_index, 1);
+}
+
+/**
+ * Interpolate \a dest_num consecutive elements starting at \a dest_index, each from \a count
+ * source elements. \a src_indices and \a weights store \a count values per destination element.
+ *
+ * Every layer is processed for all elements at once, layers that only store floats are
+ * interpolated without going through a callback for every element.
+ */
+void CustomData_interp_n(const CustomData *source,
+                         CustomData *dest,
+                         const int *src_indices,
+                         const float *weights,
+                         int count,
+                         int dest_index,
+                         int dest_num)
+{
+  customdata_interp_ex(source, dest, src_indices, weights, NULL, count, dest_index, dest_num);
+}
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data
@@ -0,0 +1,74 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "BLI_color.hh"
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+
+#include "FN_cpp_type.hh"
+
+#include "BKE_customdata.hh"
+
+namespace blender::bke {
+
+/**
+ * The type of a single element of generic property layers, null for layer types which have no
+ * equivalent #CPPType.
+ */
+const fn::CPPType *custom_data_type_to_cpp_type(const CustomDataType type)
+{
+  switch (type) {
+    case CD_PROP_FLOAT:
+      return &fn::CPPType::get<float>();
+    case CD_PROP_FLOAT2:
+      return &fn::CPPType::get<float2>();
+    case CD_PROP_FLOAT3:
+      return &fn::CPPType::get<float3>();
+    case CD_PROP_INT32:
+      return &fn::CPPType::get<int32_t>();
+    case CD_PROP_COLOR:
+      return &fn::CPPType::get<Color4f>();
+    default:
+      return nullptr;
+  }
+}
+
+CustomDataType cpp_type_to_custom_data_type(const fn::CPPType &type)
+{
+  if (type.is<float>()) {
+    return CD_PROP_FLOAT;
+  }
+  if (type.is<float2>()) {
+    return CD_PROP_FLOAT2;
+  }
+  if (type.is<float3>()) {
+    return CD_PROP_FLOAT3;
+  }
+  if (type.is<int32_t>()) {
+    return CD_PROP_INT32;
+  }
+  if (type.is<Color4f>()) {
+    return CD_PROP_COLOR;
+  }
+  BLI_assert(false);
+  return CD_PROP_FLOAT;
+}
+
+}  // namespace blender::bke
@@ -0,0 +1,189 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_base.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+/* Layers interpolated by the float fast path and by type callbacks. */
+static const CustomDataType interp_layer_types[] = {
+    CD_MLOOPCOL,
+    CD_MLOOPUV,
+    CD_PROP_FLOAT3,
+    CD_PROP_FLOAT2,
+    CD_PROP_COLOR,
+};
+
+static void fill_random(CustomDataType type, void *data, const int num, RNG *rng)
+{
+  switch (type) {
+    case CD_MLOOPCOL: {
+      uchar *data_uchar = (uchar *)data;
+      for (int i = 0; i < num * (int)sizeof(MLoopCol); i++) {
+        data_uchar[i] = (uchar)BLI_rng_get_int(rng);
+      }
+      break;
+    }
+    case CD_MLOOPUV: {
+      MLoopUV *uvs = (MLoopUV *)data;
+      for (int i = 0; i < num; i++) {
+        uvs[i].uv[0] = BLI_rng_get_float(rng) - 0.3f;
+        uvs[i].uv[1] = BLI_rng_get_float(rng) - 0.3f;
+        uvs[i].flag = BLI_rng_get_int(rng) & (MLOOPUV_VERTSEL | MLOOPUV_PINNED);
+      }
+      break;
+    }
+    default: {
+      float *data_float = (float *)data;
+      const int float_num = CustomData_sizeof(type) / (int)sizeof(float);
+      for (int i = 0; i < num * float_num; i++) {
+        data_float[i] = BLI_rng_get_float(rng) - 0.3f;
+      }
+      break;
+    }
+  }
+}
+
+/* Check one interpolated element against a weighted sum computed without the layer callbacks,
+ * missing weights count as 1. */
+static void expect_weighted_sum(CustomDataType type,
+                                const void *src_data,
+                                const void *dest_data,
+                                const int *src_indices,
+                                const float *weights,
+                                const int count)
+{
+  switch (type) {
+    case CD_MLOOPCOL: {
+      float expected[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      for (int j = 0; j < count; j++) {
+        const MLoopCol &src = ((const MLoopCol *)src_data)[src_indices[j]];
+        const float weight = weights ? weights[j] : 1.0f;
+        expected[0] += src.r * weight;
+        expected[1] += src.g * weight;
+        expected[2] += src.b * weight;
+        expected[3] += src.a * weight;
+      }
+      const MLoopCol &dest = *(const MLoopCol *)dest_data;
+      const uchar result[4] = {dest.r, dest.g, dest.b, dest.a};
+      for (int k = 0; k < 4; k++) {
+        EXPECT_NEAR(result[k], min_ff(max_ff(expected[k], 0.0f), 255.0f), 0.5f + 1e-3f);
+      }
+      break;
+    }
+    case CD_MLOOPUV: {
+      float expected[2] = {0.0f, 0.0f};
+      int expected_flag = 0;
+      for (int j = 0; j < count; j++) {
+        const MLoopUV &src = ((const MLoopUV *)src_data)[src_indices[j]];
+        const float weight = weights ? weights[j] : 1.0f;
+        expected[0] += src.uv[0] * weight;
+        expected[1] += src.uv[1] * weight;
+        if (weight > 0.0f) {
+          expected_flag |= src.flag;
+        }
+      }
+      const MLoopUV &dest = *(const MLoopUV *)dest_data;
+      EXPECT_NEAR(dest.uv[0], expected[0], 1e-5f);
+      EXPECT_NEAR(dest.uv[1], expected[1], 1e-5f);
+      EXPECT_EQ(dest.flag, expected_flag);
+      break;
+    }
+    default: {
+      const int float_num = CustomData_sizeof(type) / (int)sizeof(float);
+      for (int k = 0; k < float_num; k++) {
+        float expected = 0.0f;
+        for (int j = 0; j < count; j++) {
+          const float weight = weights ? weights[j] : 1.0f;
+          expected += ((const float *)src_data)[src_indices[j] * float_num + k] * weight;
+        }
+        EXPECT_NEAR(((const float *)dest_data)[k], expected, 1e-5f) << "layer type " << type;
+      }
+      break;
+    }
+  }
+}
+
+static void interp_n_test(const bool use_weights)
+{
+  const int src_num = 1000;
+  const int dest_num = 500;
+  const int count = 3;
+  RNG *rng = BLI_rng_new(1);
+
+  CustomData source, dest;
+  CustomData_reset(&source);
+  CustomData_reset(&dest);
+
+  for (const CustomDataType type : interp_layer_types) {
+    void *data = CustomData_add_layer(&source, type, CD_CALLOC, nullptr, src_num);
+    fill_random(type, data, src_num, rng);
+    CustomData_add_layer(&dest, type, CD_CALLOC, nullptr, dest_num);
+  }
+
+  int *src_indices = (int *)MEM_malloc_arrayN((size_t)dest_num * count, sizeof(int), __func__);
+  float *weights = (float *)MEM_malloc_arrayN((size_t)dest_num * count, sizeof(float), __func__);
+  for (int i = 0; i < dest_num * count; i++) {
+    src_indices[i] = BLI_rng_get_int(rng) % src_num;
+    /* Some zero weights, those don't contribute UV flags. */
+    weights[i] = (i % 7 == 0) ? 0.0f : BLI_rng_get_float(rng);
+  }
+  const float *weights_used = use_weights ? weights : nullptr;
+
+  CustomData_interp_n(&source, &dest, src_indices, weights_used, count, 0, dest_num);
+
+  for (const CustomDataType type : interp_layer_types) {
+    const void *src_data = CustomData_get_layer(&source, type);
+    const void *dest_data = CustomData_get_layer(&dest, type);
+    const size_t size = (size_t)CustomData_sizeof(type);
+    for (int i = 0; i < dest_num; i++) {
+      expect_weighted_sum(type,
+                          src_data,
+                          POINTER_OFFSET(dest_data, size * i),
+                          &src_indices[i * count],
+                          weights_used ? &weights_used[i * count] : nullptr,
+                          count);
+    }
+  }
+
+  MEM_freeN(src_indices);
+  MEM_freeN(weights);
+  CustomData_free(&source, src_num);
+  CustomData_free(&dest, dest_num);
+  BLI_rng_free(rng);
+}
+
+TEST(customdata, InterpN)
+{
+  interp_n_test(true);
+}
+
+TEST(customdata, InterpNNoWeights)
+{
+  interp_n_test(false);
+}
+
+}  // namespace blender::bke::tests
@@ -21,6 +21,7 @@
 
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_mempool.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_ID.h"
@@ -57,8 +58,6 @@ struct IDNameLib_Key {
 struct IDNameLib_TypeMap {
   GHash *map;
   short id_type;
-  /* only for storage of keys in the ghash, avoid many single allocs */
-  struct IDNameLib_Key *keys;
 };
 
 /**
@@ -66,6 +65,8 @@ struct IDNameLib_TypeMap {
  */
 struct IDNameLib_Map {
   struct IDNameLib_TypeMap type_maps[MAX_LIBARRAY];
+  /* For storage of keys for the TypeMap ghash, avoids many single allocs. */
+  BLI_mempool *type_maps_keys_pool;
   struct GHash *uuid_map;
   struct Main *bmain;
   struct GSet *valid_id_pointers;
@@ -105,6 +106,7 @@ struct IDNameLib_Map *BKE_main_idmap_create(struct Main *bmain,
   struct IDNameLib_Map *id_map = MEM_mallocN(sizeof(*id_map), __func__);
   id_map->bmain = bmain;
   id_map->idmap_types = idmap_types;
+  id_map->type_maps_keys_pool = NULL;
 
   int index = 0;
   while (index < MAX_LIBARRAY) {
@@ -187,13 +189,16 @@ ID *BKE_main_idmap_lookup_name(struct IDNameLib_Map *id_map,
     if (lb_len == 0) {
       return NULL;
     }
-    type_map->map = BLI_ghash_new_ex(idkey_hash, idkey_cmp, __func__, lb_len);
-    type_map->keys = MEM_mallocN(sizeof(struct IDNameLib_Key) * lb_len, __func__);
+    if (id_map->type_maps_keys_pool == NULL) {
+      id_map->type_maps_keys_pool = BLI_mempool_create(
+          sizeof(struct IDNameLib_Key), 1024, 1024, BLI_MEMPOOL_NOP);
+    }
 
+    type_map->map = BLI_ghash_new_ex(idkey_hash, idkey_cmp, __func__, lb_len);
     GHash *map = type_map->map;
-    struct IDNameLib_Key *key = type_map->keys;
 
-    for (ID *id = lb->first; id; id = id->next, key++) {
+    for (ID *id = lb->first; id; id = id->next) {
+      struct IDNameLib_Key *key = BLI_mempool_alloc(id_map->type_maps_keys_pool);
       key->name = id->name + 2;
       key->lib = id->lib;
       BLI_ghash_insert(map, key, id);
@@ -204,6 +209,32 @@ ID *BKE_main_idmap_lookup_name(struct IDNameLib_Map *id_map,
   return BLI_ghash_lookup(type_map->map, &key_lookup);
 }
 
+/**
+ * Add an ID which was added to the Main database after creation of the map.
+ * Type maps which haven't been initialized yet will include it once they are.
+ */
+void BKE_main_idmap_insert_id(struct IDNameLib_Map *id_map, ID *id)
+{
+  if (id_map->idmap_types & MAIN_IDMAP_TYPE_NAME) {
+    struct IDNameLib_TypeMap *type_map = main_idmap_from_idcode(id_map, GS(id->name));
+
+    /* Nothing to do if the map of this type hasn't been lazily created yet. */
+    if (LIKELY(type_map != NULL) && type_map->map != NULL) {
+      BLI_assert(id_map->type_maps_keys_pool != NULL);
+
+      struct IDNameLib_Key *key = BLI_mempool_alloc(id_map->type_maps_keys_pool);
+      key->name = id->name + 2;
+      key->lib = id->lib;
+      BLI_ghash_insert(type_map->map, key, id);
+    }
+  }
+
+  if (id_map->idmap_types & MAIN_IDMAP_TYPE_UUID) {
+    BLI_assert(id->session_uuid != MAIN_ID_SESSION_UUID_UNSET);
+    BLI_ghash_insert(id_map->uuid_map, POINTER_FROM_UINT(id->session_uuid), id);
+  }
+}
+
 ID *BKE_main_idmap_lookup_id(struct IDNameLib_Map *id_map, const ID *id)
 {
   /* When used during undo/redo, this function cannot assume that given id points to valid memory
@@ -234,9 +265,12 @@ void BKE_main_idmap_destroy(struct IDNameLib_Map *id_map)
       if (type_map->map) {
         BLI_ghash_free(type_map->map, NULL, NULL);
         type_map->map = NULL;
-        MEM_freeN(type_map->keys);
       }
     }
+    if (id_map->type_maps_keys_pool != NULL) {
+      BLI_mempool_destroy(id_map->type_maps_keys_pool);
+      id_map->type_maps_keys_pool = NULL;
+    }
   }
   if (id_map->idmap_types & MAIN_IDMAP_TYPE_UUID) {
     BLI_ghash_free(id_map->uuid_map, NULL, NULL);
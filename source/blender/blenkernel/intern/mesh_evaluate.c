@@ -229,9 +229,12 @@ static void mesh_calc_normals_poly_cb(void *__restrict userdata,
   BKE_mesh_calc_poly_normal(mp, data->mloop + mp->loopstart, data->mverts, data->pnors[pidx]);
 }
 
+/* Larger polygons use the worker's scratch memory instead of the stack, see below. */
+#define MESH_CALC_NORMALS_EDGEVEC_STACK 64
+
 static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
                                               const int pidx,
-                                              const TaskParallelTLS *__restrict UNUSED(tls))
+                                              const TaskParallelTLS *__restrict tls)
 {
   MeshCalcNormalsData *data = userdata;
   const MPoly *mp = &data->mpolys[pidx];
@@ -243,7 +246,13 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
   float(*lnors_weighted)[3] = data->lnors_weighted;
 
   const int nverts = mp->totloop;
-  float(*edgevecbuf)[3] = BLI_array_alloca(edgevecbuf, (size_t)nverts);
+  /* Avoid unbounded stack usage for ngons with many sides, worker threads
+   * may have a much smaller stack than the main thread. */
+  float edgevecbuf_stack[MESH_CALC_NORMALS_EDGEVEC_STACK][3];
+  float(*edgevecbuf)[3] = edgevecbuf_stack;
+  if (nverts > MESH_CALC_NORMALS_EDGEVEC_STACK) {
+    edgevecbuf = BLI_task_parallel_scratch_alloc(tls, sizeof(*edgevecbuf) * (size_t)nverts);
+  }
   int i;
 
   /* Polygon Normal and edge-vector */
@@ -776,6 +785,21 @@ void BKE_lnor_space_custom_normal_to_data(MLoopNorSpace *lnor_space,
 
 #define LOOP_SPLIT_TASK_BLOCK_SIZE 1024
 
+/** #LoopSplitTaskDataCommon.loops_tag values. */
+enum {
+  LOOP_SPLIT_TAG_NONE = 0,
+  /** Loop starts a fan ending at a sharp edge. */
+  LOOP_SPLIT_TAG_ENTRY_FAN = 1,
+  /** Both edges of the loop are sharp, it is alone in its fan. */
+  LOOP_SPLIT_TAG_ENTRY_SINGLE = 2,
+  /** Loop is the entry point of a cyclic smooth fan. */
+  LOOP_SPLIT_TAG_ENTRY_CYCLIC = 3,
+  /** Loop is part of a fan which has already been processed. */
+  LOOP_SPLIT_TAG_DONE = 4,
+  /** Loop is part of a cyclic smooth fan entered from another loop. */
+  LOOP_SPLIT_TAG_SKIP = 5,
+};
+
 typedef struct LoopSplitTaskData {
   /* Specific to each instance (each task). */
 
@@ -814,6 +838,11 @@ typedef struct LoopSplitTaskDataCommon {
   int *loop_to_poly;
   const float (*polynors)[3];
 
+  /** Temporary data of #loop_split_generator. */
+  char *loops_tag;
+  const int *entry_loops;
+  MLoopNorSpace *lnor_spaces;
+
   int numEdges;
   int numLoops;
   int numPolys;
@@ -824,12 +853,36 @@ typedef struct LoopSplitTaskDataCommon {
 /* See comment about edge_to_loops below. */
 #define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
 
+static void mesh_edges_sharp_tag_prepare_cb(void *__restrict userdata,
+                                            const int mp_index,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *data = userdata;
+  const MVert *mverts = data->mverts;
+  const MLoop *mloops = data->mloops;
+  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
+  int *loop_to_poly = data->loop_to_poly;
+
+  const MPoly *mp = &data->mpolys[mp_index];
+  const int ml_end_index = mp->loopstart + mp->totloop;
+
+  for (int ml_index = mp->loopstart; ml_index < ml_end_index; ml_index++) {
+    loop_to_poly[ml_index] = mp_index;
+
+    /* Pre-populate all loop normals as if their verts were all-smooth,
+     * this way we don't have to compute those later!
+     */
+    if (loopnors) {
+      normal_short_to_float_v3(loopnors[ml_index], mverts[mloops[ml_index].v].no);
+    }
+  }
+}
+
 static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
                                  const bool check_angle,
                                  const float split_angle,
                                  const bool do_sharp_edges_tag)
 {
-  const MVert *mverts = data->mverts;
   const MEdge *medges = data->medges;
   const MLoop *mloops = data->mloops;
 
@@ -838,7 +891,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
   const int numEdges = data->numEdges;
   const int numPolys = data->numPolys;
 
-  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
   const float(*polynors)[3] = data->polynors;
 
   int(*edge_to_loops)[2] = data->edge_to_loops;
@@ -851,6 +903,13 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
 
   const float split_angle_cos = check_angle ? cosf(split_angle) : -1.0f;
 
+  /* The loop to poly mapping is needed before the edges can be checked below,
+   * filling it does not depend on other polys and can be threaded. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, numPolys, data, mesh_edges_sharp_tag_prepare_cb, &settings);
+
   for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
     const MLoop *ml_curr;
     int *e2l;
@@ -862,15 +921,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
     for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
       e2l = edge_to_loops[ml_curr->e];
 
-      loop_to_poly[ml_curr_index] = mp_index;
-
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
-
       /* Check whether current edge might be smooth or sharp */
       if ((e2l[0] | e2l[1]) == 0) {
         /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
@@ -1092,6 +1142,7 @@ static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSpli
   MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
   float(*loopnors)[3] = common_data->loopnors;
   short(*clnors_data)[2] = common_data->clnors_data;
+  char *loops_tag = common_data->loops_tag;
 
   const MVert *mverts = common_data->mverts;
   const MEdge *medges = common_data->medges;
@@ -1213,6 +1264,10 @@ static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSpli
 
     /* We store here a pointer to all loop-normals processed. */
     BLI_SMALLSTACK_PUSH(normal, (float *)(loopnors[mlfan_vert_index]));
+    if (loops_tag) {
+      /* Only set by the threaded generator, which does not walk the fans beforehand. */
+      loops_tag[mlfan_vert_index] = LOOP_SPLIT_TAG_DONE;
+    }
 
     if (lnors_spacearr) {
       /* Assign current lnor space to current 'vertex' loop. */
@@ -1316,36 +1371,60 @@ static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
+/**
+ * Thread local data of #loop_split_worker.
+ */
+typedef struct LoopSplitTaskTLS {
+  /** Temp edge vectors stack, only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors;
+} LoopSplitTaskTLS;
+
+static void loop_split_worker(void *__restrict userdata,
+                              const int entry_index,
+                              const TaskParallelTLS *__restrict tls)
 {
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
+  LoopSplitTaskDataCommon *common_data = userdata;
+  LoopSplitTaskTLS *tls_data = tls->userdata_chunk;
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int *loop_to_poly = common_data->loop_to_poly;
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
+  const int ml_curr_index = common_data->entry_loops[entry_index];
+  const int mp_index = loop_to_poly[ml_curr_index];
+  const MPoly *mp = &mpolys[mp_index];
+  const int ml_prev_index = (ml_curr_index == mp->loopstart) ?
+                                (mp->loopstart + mp->totloop) - 1 :
+                                ml_curr_index - 1;
+
+  LoopSplitTaskData data = {
+      .lnor_space = common_data->lnor_spaces ? &common_data->lnor_spaces[entry_index] : NULL,
+      .lnor = &common_data->loopnors[ml_curr_index],
+      .ml_curr = &mloops[ml_curr_index],
+      .ml_prev = &mloops[ml_prev_index],
+      .ml_curr_index = ml_curr_index,
+      .ml_prev_index = ml_prev_index,
+      .mp_index = mp_index,
+  };
 
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
+  if (common_data->loops_tag[ml_curr_index] != LOOP_SPLIT_TAG_ENTRY_SINGLE) {
+    data.e2l_prev = edge_to_loops[data.ml_prev->e]; /* Also tag as 'fan' task. */
+    if (common_data->lnors_spacearr && tls_data->edge_vectors == NULL) {
+      tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
     }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
   }
+  loop_split_worker_do(common_data, &data, tls_data->edge_vectors);
+}
 
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
+static void loop_split_worker_free(const void *__restrict UNUSED(userdata),
+                                   void *__restrict tls_v)
+{
+  LoopSplitTaskTLS *tls_data = tls_v;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
+    tls_data->edge_vectors = NULL;
   }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
 }
 
 /**
@@ -1353,17 +1432,17 @@ static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
  * Needed because cyclic smooth fans have no obvious 'entry point',
  * and yet we need to walk them once, and only once.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static bool loop_split_generator_serial_check_cyclic_smooth_fan(const MLoop *mloops,
+                                                                const MPoly *mpolys,
+                                                                const int (*edge_to_loops)[2],
+                                                                const int *loop_to_poly,
+                                                                const int *e2l_prev,
+                                                                BLI_bitmap *skip_loops,
+                                                                const MLoop *ml_curr,
+                                                                const MLoop *ml_prev,
+                                                                const int ml_curr_index,
+                                                                const int ml_prev_index,
+                                                                const int mp_curr_index)
 {
   const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
@@ -1423,7 +1502,11 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   }
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+/**
+ * Single-threaded version of #loop_split_generator, used when there are not enough loops to be
+ * worth the threading overhead. Fans are found and processed in a single pass over the loops.
+ */
+static void loop_split_generator_serial(LoopSplitTaskDataCommon *common_data)
 {
   MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
   float(*loopnors)[3] = common_data->loopnors;
@@ -1445,23 +1528,13 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
 
   BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+  /* Temp edge vectors stack, only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors = lnors_spacearr ? BLI_stack_new(sizeof(float[3]), __func__) : NULL;
 
 #ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
+  TIMEIT_START_AVERAGED(loop_split_generator_serial);
 #endif
 
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
-    }
-  }
-
   /* We now know edges that can be smoothed (with their vector, and their two loops),
    * and edges that will be hard! Now, time to generate the normals.
    */
@@ -1479,104 +1552,44 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
       const int *e2l_curr = edge_to_loops[ml_curr->e];
       const int *e2l_prev = edge_to_loops[ml_prev->e];
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
-
       /* A smooth edge, we have to check for cyclic smooth fan case.
        * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
        * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
+      if (!IS_EDGE_SHARP(e2l_curr) &&
+          (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
+           !loop_split_generator_serial_check_cyclic_smooth_fan(mloops,
+                                                                mpolys,
+                                                                edge_to_loops,
+                                                                loop_to_poly,
+                                                                e2l_prev,
+                                                                skip_loops,
+                                                                ml_curr,
+                                                                ml_prev,
+                                                                ml_curr_index,
+                                                                ml_prev_index,
+                                                                mp_index))) {
+        /* Skipped. */
       }
       else {
-        LoopSplitTaskData *data, data_local;
-
-        //              printf("PROCESSING!\n");
-
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
+        LoopSplitTaskData data = {
+            .lnor = lnors,
+            .ml_curr = ml_curr,
+            .ml_prev = ml_prev,
+            .ml_curr_index = ml_curr_index,
+            .ml_prev_index = ml_prev_index,
+            .mp_index = mp_index,
+        };
+
+        /* We *do not need* to check/tag loops as already computed, see
+         * #loop_split_generator_tag_sharp_cb. */
+        if (!(IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev))) {
+          data.e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
         }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
+        if (lnors_spacearr) {
+          data.lnor_space = BKE_lnor_space_create(lnors_spacearr);
         }
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
+        loop_split_worker_do(common_data, &data, edge_vectors);
       }
 
       ml_prev = ml_curr;
@@ -1584,17 +1597,279 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
     }
   }
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-  }
-
   if (edge_vectors) {
     BLI_stack_free(edge_vectors);
   }
   MEM_freeN(skip_loops);
 
+#ifdef DEBUG_TIME
+  TIMEIT_END_AVERAGED(loop_split_generator_serial);
+#endif
+}
+
+/**
+ * Check whether given loop is the entry point of a cyclic smooth fan, or not.
+ * Needed because cyclic smooth fans have no obvious 'entry point',
+ * and yet we need to walk them once, and only once.
+ * The loop of the fan coming first in polygon order is used, this way every loop can be checked
+ * independently of the others. Loops of the fan after \a ml_curr which use a polygon before
+ * \a mp_block_end are tagged to be skipped, since the caller checks these polygons in order.
+ */
+static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
+                                                         const MPoly *mpolys,
+                                                         const int (*edge_to_loops)[2],
+                                                         const int *loop_to_poly,
+                                                         const int numLoops,
+                                                         const int *e2l_prev,
+                                                         const MLoop *ml_curr,
+                                                         const MLoop *ml_prev,
+                                                         const int ml_curr_index,
+                                                         const int ml_prev_index,
+                                                         const int mp_curr_index,
+                                                         const int mp_block_end,
+                                                         char *loops_tag)
+{
+  const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
+  const int *e2lfan_curr;
+  const MLoop *mlfan_curr;
+  /* mlfan_vert_index: the loop of our current edge might not be the loop of our current vertex! */
+  int mlfan_curr_index, mlfan_vert_index, mpfan_curr_index;
+
+  e2lfan_curr = e2l_prev;
+  if (IS_EDGE_SHARP(e2lfan_curr)) {
+    /* Sharp loop, so not a cyclic smooth fan... */
+    return false;
+  }
+
+  mlfan_curr = ml_prev;
+  mlfan_curr_index = ml_prev_index;
+  mlfan_vert_index = ml_curr_index;
+  mpfan_curr_index = mp_curr_index;
+
+  BLI_assert(mlfan_curr_index >= 0);
+  BLI_assert(mlfan_vert_index >= 0);
+  BLI_assert(mpfan_curr_index >= 0);
+
+  /* A fan can't have more loops than the mesh, protects against looping forever on invalid
+   * geometry where the walk does not lead back to ml_curr. */
+  for (int i = 0; i < numLoops; i++) {
+    /* Find next loop of the smooth fan. */
+    BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
+                                                mpolys,
+                                                loop_to_poly,
+                                                e2lfan_curr,
+                                                mv_pivot_index,
+                                                &mlfan_curr,
+                                                &mlfan_curr_index,
+                                                &mlfan_vert_index,
+                                                &mpfan_curr_index);
+
+    e2lfan_curr = edge_to_loops[mlfan_curr->e];
+
+    if (IS_EDGE_SHARP(e2lfan_curr)) {
+      /* Sharp loop/edge, so not a cyclic smooth fan... */
+      return false;
+    }
+    /* Smooth loop/edge... */
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan without finding any loop coming before ours,
+       * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
+      return true;
+    }
+    if (mpfan_curr_index < mp_curr_index ||
+        (mpfan_curr_index == mp_curr_index && mlfan_vert_index < ml_curr_index)) {
+      /* ... this fan will be processed from a previous loop, we can abort. */
+      return false;
+    }
+
+    /* ... not the entry point of this fan, we can skip it in future if it is checked by the same
+     * task, and keep checking the smooth fan. */
+    if (mpfan_curr_index < mp_block_end) {
+      loops_tag[mlfan_vert_index] = LOOP_SPLIT_TAG_SKIP;
+    }
+  }
+  return false;
+}
+
+static void loop_split_generator_tag_sharp_cb(void *__restrict userdata,
+                                              const int mp_index,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+
+  const MLoop *mloops = common_data->mloops;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  char *loops_tag = common_data->loops_tag;
+
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_curr_index = mp->loopstart;
+
+  const int *e2l_prev = edge_to_loops[mloops[ml_last_index].e];
+
+  for (; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    const int *e2l_curr = edge_to_loops[mloops[ml_curr_index].e];
+
+    /* A sharp edge, this loop starts a fan, or is a 'single' loop when both its edges are sharp.
+     *
+     * We *do not need* to check/tag loops as already computed!
+     * Due to the fact a loop only links to one of its two edges,
+     * a same fan *will never be walked more than once!*
+     * Since we consider edges having neighbor polys with inverted
+     * (flipped) normals as sharp, we are sure that no fan will be skipped,
+     * even only considering the case (sharp curr_edge, smooth prev_edge),
+     * and not the alternative (smooth curr_edge, sharp prev_edge).
+     * All this due/thanks to link between normals and loop ordering (i.e. winding).
+     */
+    if (IS_EDGE_SHARP(e2l_curr)) {
+      loops_tag[ml_curr_index] = IS_EDGE_SHARP(e2l_prev) ? LOOP_SPLIT_TAG_ENTRY_SINGLE :
+                                                           LOOP_SPLIT_TAG_ENTRY_FAN;
+    }
+
+    e2l_prev = e2l_curr;
+  }
+}
+
+static void loop_split_generator_tag_cyclic_cb(void *__restrict userdata,
+                                               const int block_index,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int numLoops = common_data->numLoops;
+  char *loops_tag = common_data->loops_tag;
+
+  /* Polys are checked by blocks, so that loops of a fan already walked from an other loop of
+   * the same block can be skipped, without writing to loops checked by other tasks. */
+  const int mp_block_start = block_index * LOOP_SPLIT_TASK_BLOCK_SIZE;
+  const int mp_block_end = min_ii(mp_block_start + LOOP_SPLIT_TASK_BLOCK_SIZE,
+                                  common_data->numPolys);
+
+  for (int mp_index = mp_block_start; mp_index < mp_block_end; mp_index++) {
+    const MPoly *mp = &mpolys[mp_index];
+    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+    int ml_curr_index = mp->loopstart;
+    int ml_prev_index = ml_last_index;
+
+    for (; ml_curr_index <= ml_last_index; ml_prev_index = ml_curr_index++) {
+      /* A smooth edge which is not part of an already processed fan, we have to check for cyclic
+       * smooth fan case. If this loop is the entry point of a cyclic smooth fan, we can do it
+       * using that loop/edge, otherwise we can skip it.
+       *
+       * Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
+       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
+       * the vert during actual computation of clnor & clnorspace. However, this would complicate
+       * the code, add more memory usage, and despite its logical complexity,
+       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
+       * so really think it's not worth it. */
+      if (loops_tag[ml_curr_index] != LOOP_SPLIT_TAG_NONE) {
+        continue;
+      }
+
+      const MLoop *ml_curr = &mloops[ml_curr_index];
+      const MLoop *ml_prev = &mloops[ml_prev_index];
+      if (loop_split_generator_check_cyclic_smooth_fan(mloops,
+                                                       mpolys,
+                                                       edge_to_loops,
+                                                       loop_to_poly,
+                                                       numLoops,
+                                                       edge_to_loops[ml_prev->e],
+                                                       ml_curr,
+                                                       ml_prev,
+                                                       ml_curr_index,
+                                                       ml_prev_index,
+                                                       mp_index,
+                                                       mp_block_end,
+                                                       loops_tag)) {
+        loops_tag[ml_curr_index] = LOOP_SPLIT_TAG_ENTRY_CYCLIC;
+      }
+    }
+  }
+}
+
+/**
+ * Compute the normals of all fans starting at loops tagged with \a tag_first or \a tag_last.
+ */
+static void loop_split_generator_process(LoopSplitTaskDataCommon *common_data,
+                                         const char tag_first,
+                                         const char tag_last,
+                                         const TaskParallelSettings *settings)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  const char *loops_tag = common_data->loops_tag;
+  const int numLoops = common_data->numLoops;
+
+  int *entry_loops = MEM_malloc_arrayN((size_t)numLoops, sizeof(*entry_loops), __func__);
+  int entry_loops_num = 0;
+  for (int ml_index = 0; ml_index < numLoops; ml_index++) {
+    if (loops_tag[ml_index] >= tag_first && loops_tag[ml_index] <= tag_last) {
+      entry_loops[entry_loops_num++] = ml_index;
+    }
+  }
+
+  common_data->entry_loops = entry_loops;
+  if (lnors_spacearr) {
+    /* We have to create those outside of tasks, since the memarena is not threadsafe. */
+    common_data->lnor_spaces = BLI_memarena_calloc(
+        lnors_spacearr->mem, sizeof(*common_data->lnor_spaces) * (size_t)entry_loops_num);
+    lnors_spacearr->num_spaces += entry_loops_num;
+  }
+
+  LoopSplitTaskTLS tls_data = {NULL};
+  TaskParallelSettings worker_settings = *settings;
+  worker_settings.userdata_chunk = &tls_data;
+  worker_settings.userdata_chunk_size = sizeof(tls_data);
+  worker_settings.func_free = loop_split_worker_free;
+  BLI_task_parallel_range(0, entry_loops_num, common_data, loop_split_worker, &worker_settings);
+
+  common_data->entry_loops = NULL;
+  common_data->lnor_spaces = NULL;
+  MEM_freeN(entry_loops);
+}
+
+/**
+ * Find the loops from which smooth fans (and 'single' loops) have to be processed, and process
+ * them in threads. Fans ending at a sharp edge are done first, the remaining loops around smooth
+ * edges are then either part of a cyclic smooth fan, or already done.
+ */
+static void loop_split_generator(LoopSplitTaskDataCommon *common_data)
+{
+  const int numLoops = common_data->numLoops;
+  const int numPolys = common_data->numPolys;
+
+#ifdef DEBUG_TIME
+  TIMEIT_START_AVERAGED(loop_split_generator);
+#endif
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
+
+  /* Note: a char per loop rather than a bitmap, since it is written from several threads. */
+  common_data->loops_tag = MEM_calloc_arrayN((size_t)numLoops, sizeof(char), __func__);
+
+  /* We now know edges that can be smoothed (with their vector, and their two loops),
+   * and edges that will be hard! Now, time to generate the normals. */
+  BLI_task_parallel_range(0, numPolys, common_data, loop_split_generator_tag_sharp_cb, &settings);
+  loop_split_generator_process(
+      common_data, LOOP_SPLIT_TAG_ENTRY_FAN, LOOP_SPLIT_TAG_ENTRY_SINGLE, &settings);
+
+  /* Loops of the fans done above are tagged as such, only cyclic smooth fans remain. */
+  const int blocks_num = (numPolys + LOOP_SPLIT_TASK_BLOCK_SIZE - 1) / LOOP_SPLIT_TASK_BLOCK_SIZE;
+  TaskParallelSettings block_settings = settings;
+  block_settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, blocks_num, common_data, loop_split_generator_tag_cyclic_cb, &block_settings);
+  loop_split_generator_process(
+      common_data, LOOP_SPLIT_TAG_ENTRY_CYCLIC, LOOP_SPLIT_TAG_ENTRY_CYCLIC, &settings);
+
+  MEM_freeN(common_data->loops_tag);
+  common_data->loops_tag = NULL;
+
 #ifdef DEBUG_TIME
   TIMEIT_END_AVERAGED(loop_split_generator);
 #endif
@@ -1716,16 +1991,10 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
 
   if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
     /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
+    loop_split_generator_serial(&common_data);
   }
   else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
-
-    loop_split_generator(task_pool, &common_data);
-
-    BLI_task_pool_work_and_wait(task_pool);
-
-    BLI_task_pool_free(task_pool);
+    loop_split_generator(&common_data);
   }
 
   MEM_freeN(edge_to_loops);
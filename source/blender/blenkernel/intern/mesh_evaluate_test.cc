@@ -0,0 +1,289 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_linklist.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+class mesh_normals_loop_split : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/* Size of the torus grid of a single tile. */
+#define TORUS_U 12
+#define TORUS_V 8
+
+/**
+ * \a tiles_num copies of a smooth torus, which only has cyclic smooth fans, with some features
+ * which make fans end early: flipped faces, a flat face, a sharp edge and a fin face on an edge
+ * used by three faces. The copies don't share vertices, so each gives the same normals.
+ */
+static Mesh *tiled_torus_mesh(const int tiles_num)
+{
+  const int grid_polys_num = TORUS_U * TORUS_V;
+  const int tile_verts_num = grid_polys_num + 2;
+  const int tile_polys_num = grid_polys_num + 1;
+  const int tile_loops_num = tile_polys_num * 4;
+
+  Mesh *mesh = BKE_mesh_new_nomain(tile_verts_num * tiles_num,
+                                   0,
+                                   0,
+                                   tile_loops_num * tiles_num,
+                                   tile_polys_num * tiles_num);
+  RNG *rng = BLI_rng_new(0);
+
+  /* Same positions for every tile, jittered so the split angle matters for some edges. */
+  float(*tile_co)[3] = (float(*)[3])MEM_malloc_arrayN(
+      (size_t)tile_verts_num, sizeof(float[3]), __func__);
+  for (int u = 0; u < TORUS_U; u++) {
+    for (int v = 0; v < TORUS_V; v++) {
+      const float angle_u = (float)u * 2.0f * (float)M_PI / TORUS_U;
+      const float angle_v = (float)v * 2.0f * (float)M_PI / TORUS_V;
+      const float radius = 2.0f + 0.7f * cosf(angle_v) + 0.2f * BLI_rng_get_float(rng);
+      float *co = tile_co[u * TORUS_V + v];
+      co[0] = radius * cosf(angle_u);
+      co[1] = radius * sinf(angle_u);
+      co[2] = 0.7f * sinf(angle_v);
+    }
+  }
+  /* The fin, sticking out of the edge between the first two vertices. */
+  add_v3_v3v3(tile_co[grid_polys_num], tile_co[1], tile_co[1]);
+  add_v3_v3v3(tile_co[grid_polys_num + 1], tile_co[0], tile_co[0]);
+
+  for (int tile = 0; tile < tiles_num; tile++) {
+    const uint vert_offset = (uint)(tile * tile_verts_num);
+    const int poly_offset = tile * tile_polys_num;
+
+    for (int i = 0; i < tile_verts_num; i++) {
+      copy_v3_v3(mesh->mvert[vert_offset + (uint)i].co, tile_co[i]);
+    }
+
+    for (int i = 0; i < tile_polys_num; i++) {
+      MPoly *mp = &mesh->mpoly[poly_offset + i];
+      mp->loopstart = (poly_offset + i) * 4;
+      mp->totloop = 4;
+      mp->flag = ME_SMOOTH;
+    }
+
+    for (int u = 0; u < TORUS_U; u++) {
+      for (int v = 0; v < TORUS_V; v++) {
+        const int u_next = (u + 1) % TORUS_U;
+        const int v_next = (v + 1) % TORUS_V;
+        uint quad[4] = {(uint)(u * TORUS_V + v),
+                        (uint)(u_next * TORUS_V + v),
+                        (uint)(u_next * TORUS_V + v_next),
+                        (uint)(u * TORUS_V + v_next)};
+        const int poly_index = u * TORUS_V + v;
+        /* Two flipped faces, one of them next to the fin. */
+        if (ELEM(poly_index, 1, 37)) {
+          SWAP(uint, quad[1], quad[3]);
+        }
+        MLoop *ml = &mesh->mloop[(poly_offset + poly_index) * 4];
+        for (int j = 0; j < 4; j++) {
+          ml[j].v = quad[j] + vert_offset;
+        }
+      }
+    }
+    const uint fin[4] = {0, 1, grid_polys_num, grid_polys_num + 1};
+    MLoop *ml = &mesh->mloop[(poly_offset + grid_polys_num) * 4];
+    for (int j = 0; j < 4; j++) {
+      ml[j].v = fin[j] + vert_offset;
+    }
+
+    mesh->mpoly[poly_offset + 50].flag &= ~ME_SMOOTH;
+  }
+
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  /* One edge tagged as sharp in every tile, found through its loop since the edge order depends
+   * on the other tiles. */
+  for (int tile = 0; tile < tiles_num; tile++) {
+    const MLoop *ml = &mesh->mloop[(tile * tile_polys_num + 70) * 4];
+    mesh->medge[ml->e].flag |= ME_SHARP;
+  }
+
+  MEM_freeN(tile_co);
+  BLI_rng_free(rng);
+  return mesh;
+}
+
+struct LoopSplitResult {
+  float (*loopnors)[3];
+  MLoopNorSpaceArray lnors_spacearr;
+};
+
+static LoopSplitResult normals_loop_split(Mesh *mesh, short (*clnors)[2])
+{
+  float(*polynors)[3] = (float(*)[3])MEM_malloc_arrayN(
+      (size_t)mesh->totpoly, sizeof(float[3]), __func__);
+  BKE_mesh_calc_normals_poly(mesh->mvert,
+                             nullptr,
+                             mesh->totvert,
+                             mesh->mloop,
+                             mesh->mpoly,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             polynors,
+                             false);
+
+  LoopSplitResult result = {nullptr, {nullptr}};
+  result.loopnors = (float(*)[3])MEM_calloc_arrayN(
+      (size_t)mesh->totloop, sizeof(float[3]), __func__);
+  BKE_mesh_normals_loop_split(mesh->mvert,
+                              mesh->totvert,
+                              mesh->medge,
+                              mesh->totedge,
+                              mesh->mloop,
+                              result.loopnors,
+                              mesh->totloop,
+                              mesh->mpoly,
+                              polynors,
+                              mesh->totpoly,
+                              true,
+                              DEG2RADF(60.0f),
+                              &result.lnors_spacearr,
+                              clnors,
+                              nullptr);
+
+  MEM_freeN(polynors);
+  return result;
+}
+
+static std::vector<int> lnor_space_loops(const MLoopNorSpace *lnor_space, const int loop_offset)
+{
+  std::vector<int> loops;
+  if (lnor_space->flags & MLNOR_SPACE_IS_SINGLE) {
+    loops.push_back(POINTER_AS_INT(lnor_space->loops) - loop_offset);
+  }
+  else {
+    for (const LinkNode *node = lnor_space->loops; node; node = node->next) {
+      loops.push_back(POINTER_AS_INT(node->link) - loop_offset);
+    }
+  }
+  std::sort(loops.begin(), loops.end());
+  return loops;
+}
+
+/**
+ * A single tile is small enough to be handled by the single-threaded generator, the tiled mesh
+ * is processed with the threaded one. Both have to find the same fans.
+ */
+static void normals_loop_split_test(const bool use_custom_normals)
+{
+  const int tiles_num = 24;
+  Mesh *mesh_tile = tiled_torus_mesh(1);
+  Mesh *mesh_tiled = tiled_torus_mesh(tiles_num);
+  const int tile_loops_num = mesh_tile->totloop;
+  ASSERT_LT(tile_loops_num, 1024 * 8);
+  ASSERT_GE(mesh_tiled->totloop, 1024 * 8);
+
+  short(*clnors_tile)[2] = nullptr;
+  short(*clnors_tiled)[2] = nullptr;
+  if (use_custom_normals) {
+    RNG *rng = BLI_rng_new(1);
+    clnors_tile = (short(*)[2])MEM_malloc_arrayN(
+        (size_t)tile_loops_num, sizeof(short[2]), __func__);
+    clnors_tiled = (short(*)[2])MEM_malloc_arrayN(
+        (size_t)mesh_tiled->totloop, sizeof(short[2]), __func__);
+    for (int i = 0; i < tile_loops_num; i++) {
+      clnors_tile[i][0] = (short)(BLI_rng_get_int(rng) % 20000 - 10000);
+      clnors_tile[i][1] = (short)(BLI_rng_get_int(rng) % 20000 - 10000);
+    }
+    for (int i = 0; i < mesh_tiled->totloop; i++) {
+      copy_v2_v2_short(clnors_tiled[i], clnors_tile[i % tile_loops_num]);
+    }
+    BLI_rng_free(rng);
+  }
+
+  LoopSplitResult result_tile = normals_loop_split(mesh_tile, clnors_tile);
+  LoopSplitResult result_tiled = normals_loop_split(mesh_tiled, clnors_tiled);
+
+  int single_spaces_num = 0;
+  int fan_spaces_num = 0;
+  for (int tile = 0; tile < tiles_num; tile++) {
+    const int loop_offset = tile * tile_loops_num;
+    for (int i = 0; i < tile_loops_num; i++) {
+      EXPECT_V3_NEAR(result_tiled.loopnors[loop_offset + i], result_tile.loopnors[i], 1e-6f);
+
+      const MLoopNorSpace *space_tile = result_tile.lnors_spacearr.lspacearr[i];
+      const MLoopNorSpace *space_tiled = result_tiled.lnors_spacearr.lspacearr[loop_offset + i];
+      ASSERT_NE(space_tile, nullptr);
+      ASSERT_NE(space_tiled, nullptr);
+      EXPECT_V3_NEAR(space_tiled->vec_lnor, space_tile->vec_lnor, 1e-6f);
+      EXPECT_V3_NEAR(space_tiled->vec_ref, space_tile->vec_ref, 1e-6f);
+      EXPECT_V3_NEAR(space_tiled->vec_ortho, space_tile->vec_ortho, 1e-6f);
+      EXPECT_NEAR(space_tiled->ref_alpha, space_tile->ref_alpha, 1e-6f);
+      EXPECT_NEAR(space_tiled->ref_beta, space_tile->ref_beta, 1e-6f);
+      EXPECT_EQ(space_tiled->flags, space_tile->flags);
+      EXPECT_EQ(lnor_space_loops(space_tiled, loop_offset), lnor_space_loops(space_tile, 0));
+
+      if (tile == 0) {
+        if (space_tile->flags & MLNOR_SPACE_IS_SINGLE) {
+          single_spaces_num++;
+        }
+        else {
+          fan_spaces_num += (lnor_space_loops(space_tile, 0)[0] == i);
+        }
+      }
+    }
+  }
+  EXPECT_EQ(result_tiled.lnors_spacearr.num_spaces,
+            result_tile.lnors_spacearr.num_spaces * tiles_num);
+  /* The features above give both kinds of spaces. */
+  EXPECT_GT(single_spaces_num, 0);
+  EXPECT_GT(fan_spaces_num, 0);
+
+  for (LoopSplitResult *result : {&result_tile, &result_tiled}) {
+    MEM_freeN(result->loopnors);
+    BKE_lnor_spacearr_free(&result->lnors_spacearr);
+  }
+  MEM_SAFE_FREE(clnors_tile);
+  MEM_SAFE_FREE(clnors_tiled);
+  BKE_id_free(nullptr, mesh_tile);
+  BKE_id_free(nullptr, mesh_tiled);
+}
+
+TEST_F(mesh_normals_loop_split, ThreadedMatchesSerial)
+{
+  normals_loop_split_test(false);
+}
+
+TEST_F(mesh_normals_loop_split, ThreadedMatchesSerialCustomNormals)
+{
+  normals_loop_split_test(true);
+}
+
+}  // namespace blender::bke::tests
@@ -0,0 +1,723 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_curveprofile_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_session_uuid.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "atomic_ops.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_modifier_cache.h"
+#include "BKE_modifier.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Hashing
+ *
+ * A 64 bit hash is used, since a collision would silently give a wrong result.
+ * \{ */
+
+#define HASH_SEED 0xcbf29ce484222325ull
+#define HASH_MULTIPLIER 0x9e3779b97f4a7c15ull
+
+BLI_INLINE uint64_t hash_uint64(uint64_t hash, const uint64_t value)
+{
+  hash = (hash ^ value) * HASH_MULTIPLIER;
+  return hash ^ (hash >> 32);
+}
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, const size_t size)
+{
+  const char *bytes = data;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t value;
+    memcpy(&value, bytes + i, sizeof(value));
+    hash = hash_uint64(hash, value);
+  }
+  if (i < size) {
+    uint64_t value = 0;
+    memcpy(&value, bytes + i, size - i);
+    hash = hash_uint64(hash, value);
+  }
+  return hash_uint64(hash, size);
+}
+
+static uint64_t hash_string(const uint64_t hash, const char *str)
+{
+  return hash_bytes(hash, str, strlen(str));
+}
+
+/**
+ * \return False when the layers contain data that can't be hashed.
+ */
+static bool hash_customdata(uint64_t *hash, const CustomData *data, const int totelem)
+{
+  *hash = hash_uint64(*hash, (uint64_t)totelem);
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    *hash = hash_uint64(*hash, (uint64_t)layer->type);
+    *hash = hash_string(*hash, layer->name);
+    if (layer->data == NULL) {
+      continue;
+    }
+    switch (layer->type) {
+      case CD_MDEFORMVERT: {
+        /* Hash the weights, the pointers to them change with every copy. */
+        const MDeformVert *dvert = layer->data;
+        for (int j = 0; j < totelem; j++) {
+          *hash = hash_uint64(*hash, (uint64_t)dvert[j].totweight);
+          if (dvert[j].dw) {
+            *hash = hash_bytes(
+                *hash, dvert[j].dw, sizeof(*dvert[j].dw) * (size_t)dvert[j].totweight);
+          }
+        }
+        break;
+      }
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+        /* Pointers to separately allocated data, not worth supporting since multires
+         * isn't cached anyway. */
+        return false;
+      default:
+        *hash = hash_bytes(*hash, layer->data, (size_t)CustomData_sizeof(layer->type) * totelem);
+        break;
+    }
+  }
+  return true;
+}
+
+/**
+ * Only the points the user defined, the sampled tables are derived from them.
+ */
+static uint64_t hash_curve_profile(uint64_t hash, const CurveProfile *profile)
+{
+  hash = hash_uint64(hash, (uint64_t)profile->path_len);
+  hash = hash_uint64(hash, (uint64_t)profile->preset);
+  hash = hash_uint64(hash, (uint64_t)profile->flag);
+  for (int i = 0; i < profile->path_len; i++) {
+    const CurveProfilePoint *point = &profile->path[i];
+    hash = hash_bytes(hash, &point->x, sizeof(point->x) * 2);
+    hash = hash_uint64(hash, ((uint64_t)point->h1 << 8) | (uint64_t)point->h2);
+    hash = hash_bytes(hash, point->h1_loc, sizeof(point->h1_loc));
+    hash = hash_bytes(hash, point->h2_loc, sizeof(point->h2_loc));
+  }
+  return hash;
+}
+
+static uint64_t mesh_data_key_calc(const Mesh *mesh)
+{
+  uint64_t hash = HASH_SEED;
+  if (!hash_customdata(&hash, &mesh->vdata, mesh->totvert) ||
+      !hash_customdata(&hash, &mesh->edata, mesh->totedge) ||
+      !hash_customdata(&hash, &mesh->pdata, mesh->totpoly) ||
+      !hash_customdata(&hash, &mesh->ldata, mesh->totloop)) {
+    return MESH_MODIFIER_CACHE_KEY_NONE;
+  }
+  return (hash == MESH_MODIFIER_CACHE_KEY_NONE) ? 1 : hash;
+}
+
+/**
+ * Hash of the custom data of \a mesh.
+ *
+ * Copy-on-write meshes are never changed in place, the depsgraph copies the original mesh again
+ * when it changes. Their hash is therefore only calculated once and kept in the runtime data,
+ * so re-evaluating the modifiers (e.g. when their settings change) doesn't read the whole mesh.
+ */
+static uint64_t mesh_data_key_get(Mesh *mesh)
+{
+  if ((mesh->id.tag & LIB_TAG_COPIED_ON_WRITE) == 0) {
+    return mesh_data_key_calc(mesh);
+  }
+  if (mesh->runtime.modifier_cache_data_key != MESH_MODIFIER_CACHE_KEY_NONE) {
+    return mesh->runtime.modifier_cache_data_key;
+  }
+  const uint64_t key = mesh_data_key_calc(mesh);
+  if (key != MESH_MODIFIER_CACHE_KEY_NONE) {
+    /* Objects sharing the mesh are evaluated in parallel, they all calculate the same key. */
+    atomic_cas_uint64(&mesh->runtime.modifier_cache_data_key, MESH_MODIFIER_CACHE_KEY_NONE, key);
+  }
+  return key;
+}
+
+/**
+ * Key of the mesh which is passed to the first modifier that can be cached, so the keys of all
+ * following modifiers depend on it.
+ *
+ * \param deformed_verts: Coordinates replacing the ones of \a mesh, can be NULL.
+ * \param apply_flag: The #ModifierApplyFlag the modifiers are evaluated with.
+ * \return #MESH_MODIFIER_CACHE_KEY_NONE when the mesh can't be cached.
+ */
+uint64_t BKE_mesh_modifier_cache_key_init(const Scene *scene,
+                                          const Object *ob,
+                                          Mesh *mesh,
+                                          const float (*deformed_verts)[3],
+                                          const int num_deformed_verts,
+                                          const int apply_flag,
+                                          const bool need_mapping)
+{
+  const uint64_t data_key = mesh_data_key_get(mesh);
+  if (data_key == MESH_MODIFIER_CACHE_KEY_NONE) {
+    return MESH_MODIFIER_CACHE_KEY_NONE;
+  }
+
+  uint64_t hash = hash_uint64(HASH_SEED, data_key);
+  if (deformed_verts) {
+    /* Only present with leading deform modifiers, which already process all vertices. */
+    hash = hash_bytes(hash, deformed_verts, sizeof(*deformed_verts) * (size_t)num_deformed_verts);
+  }
+
+  /* Mesh settings that are used by modifiers. */
+  hash = hash_uint64(hash, (uint64_t)mesh->flag);
+  hash = hash_uint64(hash, (uint64_t)mesh->cd_flag);
+  hash = hash_uint64(hash, (uint64_t)mesh->totcol);
+  hash = hash_bytes(hash, &mesh->smoothresh, sizeof(mesh->smoothresh));
+  hash = hash_bytes(hash, mesh->loc, sizeof(mesh->loc));
+  hash = hash_bytes(hash, mesh->size, sizeof(mesh->size));
+
+  /* Vertex groups are looked up by name in the object. */
+  LISTBASE_FOREACH (const bDeformGroup *, dg, &ob->defbase) {
+    hash = hash_string(hash, dg->name);
+  }
+
+  /* Simplify changes the subdivision levels. */
+  hash = hash_uint64(hash, (uint64_t)(scene->r.mode & R_SIMPLIFY));
+  hash = hash_uint64(hash, (uint64_t)scene->r.simplify_subsurf);
+  hash = hash_uint64(hash, (uint64_t)scene->r.simplify_subsurf_render);
+
+  hash = hash_uint64(hash, (uint64_t)apply_flag);
+  hash = hash_uint64(hash, (uint64_t)need_mapping);
+
+  return (hash == MESH_MODIFIER_CACHE_KEY_NONE) ? 1 : hash;
+}
+
+#define HASH_FIELD(data, field) hash = hash_bytes(hash, &(data)->field, sizeof((data)->field))
+#define HASH_STRING(data, field) hash = hash_string(hash, (data)->field)
+
+/**
+ * The size of the settings is checked, so adding a field to one of the hashed modifiers fails to
+ * compile until it's added to #modifier_settings_hash (or explicitly skipped).
+ * DNA structs have explicit padding, so their size is the sum of their fields.
+ */
+#define SETTINGS_SIZE_CHECK(type, bytes_num, pointers_num) \
+  BLI_STATIC_ASSERT(sizeof(type) == \
+                        sizeof(ModifierData) + (bytes_num) + (pointers_num) * sizeof(void *), \
+                    "Settings of " #type " changed, update modifier_settings_hash()")
+
+SETTINGS_SIZE_CHECK(SubsurfModifierData, 16, 2);
+SETTINGS_SIZE_CHECK(MirrorModifierData, 24, 1);
+SETTINGS_SIZE_CHECK(ArrayModifierData, 56, 4);
+SETTINGS_SIZE_CHECK(SolidifyModifierData, 240, 0);
+SETTINGS_SIZE_CHECK(BevelModifierData, 112, 1);
+SETTINGS_SIZE_CHECK(TriangulateModifierData, 16, 0);
+SETTINGS_SIZE_CHECK(EdgeSplitModifierData, 8, 0);
+SETTINGS_SIZE_CHECK(WeldModifierData, 80, 0);
+SETTINGS_SIZE_CHECK(DecimateModifierData, 88, 0);
+SETTINGS_SIZE_CHECK(WireframeModifierData, 88, 0);
+SETTINGS_SIZE_CHECK(SmoothModifierData, 72, 0);
+SETTINGS_SIZE_CHECK(RemeshModifierData, 24, 0);
+
+/**
+ * Hash the settings that define the result of \a md, listed per modifier type. Hashing the DNA
+ * struct as a whole isn't reliable: modifiers write runtime data into their settings during
+ * evaluation (e.g. the face count of the decimate modifier, the bind coordinates of the corrective
+ * smooth modifier), and data they own is changed without changing its address.
+ *
+ * Pointers to other IDs aren't hashed, modifiers using them aren't cached,
+ * see #BKE_mesh_modifier_cache_supported.
+ *
+ * \return False when the type of \a md isn't listed, its result can't be cached.
+ */
+static bool modifier_settings_hash(const ModifierData *md, uint64_t *r_hash)
+{
+  uint64_t hash = *r_hash;
+
+  switch ((ModifierType)md->type) {
+    case eModifierType_Subsurf: {
+      /* The CCG caches are derived from the input mesh. */
+      const SubsurfModifierData *smd = (const SubsurfModifierData *)md;
+      HASH_FIELD(smd, subdivType);
+      HASH_FIELD(smd, levels);
+      HASH_FIELD(smd, renderLevels);
+      HASH_FIELD(smd, flags);
+      HASH_FIELD(smd, uv_smooth);
+      HASH_FIELD(smd, quality);
+      break;
+    }
+    case eModifierType_Mirror: {
+      const MirrorModifierData *mmd = (const MirrorModifierData *)md;
+      HASH_FIELD(mmd, flag);
+      HASH_FIELD(mmd, tolerance);
+      HASH_FIELD(mmd, uv_offset);
+      HASH_FIELD(mmd, uv_offset_copy);
+      break;
+    }
+    case eModifierType_Array: {
+      const ArrayModifierData *amd = (const ArrayModifierData *)md;
+      HASH_FIELD(amd, offset);
+      HASH_FIELD(amd, scale);
+      HASH_FIELD(amd, length);
+      HASH_FIELD(amd, merge_dist);
+      HASH_FIELD(amd, fit_type);
+      HASH_FIELD(amd, offset_type);
+      HASH_FIELD(amd, flags);
+      HASH_FIELD(amd, count);
+      HASH_FIELD(amd, uv_offset);
+      break;
+    }
+    case eModifierType_Solidify: {
+      const SolidifyModifierData *smd = (const SolidifyModifierData *)md;
+      HASH_STRING(smd, defgrp_name);
+      HASH_STRING(smd, shell_defgrp_name);
+      HASH_STRING(smd, rim_defgrp_name);
+      HASH_FIELD(smd, offset);
+      HASH_FIELD(smd, offset_fac);
+      HASH_FIELD(smd, offset_fac_vg);
+      HASH_FIELD(smd, offset_clamp);
+      HASH_FIELD(smd, mode);
+      HASH_FIELD(smd, nonmanifold_offset_mode);
+      HASH_FIELD(smd, nonmanifold_boundary_mode);
+      HASH_FIELD(smd, crease_inner);
+      HASH_FIELD(smd, crease_outer);
+      HASH_FIELD(smd, crease_rim);
+      HASH_FIELD(smd, flag);
+      HASH_FIELD(smd, mat_ofs);
+      HASH_FIELD(smd, mat_ofs_rim);
+      HASH_FIELD(smd, merge_tolerance);
+      HASH_FIELD(smd, bevel_convex);
+      break;
+    }
+    case eModifierType_Bevel: {
+      const BevelModifierData *bmd = (const BevelModifierData *)md;
+      HASH_FIELD(bmd, value);
+      HASH_FIELD(bmd, res);
+      HASH_FIELD(bmd, flags);
+      HASH_FIELD(bmd, val_flags);
+      HASH_FIELD(bmd, profile_type);
+      HASH_FIELD(bmd, lim_flags);
+      HASH_FIELD(bmd, e_flags);
+      HASH_FIELD(bmd, mat);
+      HASH_FIELD(bmd, edge_flags);
+      HASH_FIELD(bmd, face_str_mode);
+      HASH_FIELD(bmd, miter_inner);
+      HASH_FIELD(bmd, miter_outer);
+      HASH_FIELD(bmd, vmesh_method);
+      HASH_FIELD(bmd, affect_type);
+      HASH_FIELD(bmd, profile);
+      HASH_FIELD(bmd, bevel_angle);
+      HASH_FIELD(bmd, spread);
+      HASH_STRING(bmd, defgrp_name);
+      if (bmd->custom_profile) {
+        hash = hash_curve_profile(hash, bmd->custom_profile);
+      }
+      break;
+    }
+    case eModifierType_Triangulate: {
+      const TriangulateModifierData *tmd = (const TriangulateModifierData *)md;
+      HASH_FIELD(tmd, flag);
+      HASH_FIELD(tmd, quad_method);
+      HASH_FIELD(tmd, ngon_method);
+      HASH_FIELD(tmd, min_vertices);
+      break;
+    }
+    case eModifierType_EdgeSplit: {
+      const EdgeSplitModifierData *emd = (const EdgeSplitModifierData *)md;
+      HASH_FIELD(emd, split_angle);
+      HASH_FIELD(emd, flags);
+      break;
+    }
+    case eModifierType_Weld: {
+      const WeldModifierData *wmd = (const WeldModifierData *)md;
+      HASH_FIELD(wmd, merge_dist);
+      HASH_FIELD(wmd, max_interactions);
+      HASH_STRING(wmd, defgrp_name);
+      HASH_FIELD(wmd, flag);
+      break;
+    }
+    case eModifierType_Decimate: {
+      /* The face count is written by the evaluation. */
+      const DecimateModifierData *dmd = (const DecimateModifierData *)md;
+      HASH_FIELD(dmd, percent);
+      HASH_FIELD(dmd, iter);
+      HASH_FIELD(dmd, delimit);
+      HASH_FIELD(dmd, symmetry_axis);
+      HASH_FIELD(dmd, angle);
+      HASH_STRING(dmd, defgrp_name);
+      HASH_FIELD(dmd, defgrp_factor);
+      HASH_FIELD(dmd, flag);
+      HASH_FIELD(dmd, mode);
+      break;
+    }
+    case eModifierType_Wireframe: {
+      const WireframeModifierData *wmd = (const WireframeModifierData *)md;
+      HASH_STRING(wmd, defgrp_name);
+      HASH_FIELD(wmd, offset);
+      HASH_FIELD(wmd, offset_fac);
+      HASH_FIELD(wmd, offset_fac_vg);
+      HASH_FIELD(wmd, crease_weight);
+      HASH_FIELD(wmd, flag);
+      HASH_FIELD(wmd, mat_ofs);
+      break;
+    }
+    case eModifierType_Smooth: {
+      const SmoothModifierData *smd = (const SmoothModifierData *)md;
+      HASH_FIELD(smd, fac);
+      HASH_STRING(smd, defgrp_name);
+      HASH_FIELD(smd, flag);
+      HASH_FIELD(smd, repeat);
+      break;
+    }
+    case eModifierType_Remesh: {
+      const RemeshModifierData *rmd = (const RemeshModifierData *)md;
+      HASH_FIELD(rmd, threshold);
+      HASH_FIELD(rmd, scale);
+      HASH_FIELD(rmd, hermite_num);
+      HASH_FIELD(rmd, depth);
+      HASH_FIELD(rmd, flag);
+      HASH_FIELD(rmd, mode);
+      HASH_FIELD(rmd, voxel_size);
+      HASH_FIELD(rmd, adaptivity);
+      break;
+    }
+    default:
+      return false;
+  }
+
+  *r_hash = hash;
+  return true;
+}
+
+#undef HASH_FIELD
+#undef HASH_STRING
+#undef SETTINGS_SIZE_CHECK
+
+/**
+ * Key of the result of \a md, given the key of its input.
+ *
+ * \param mask, next_mask: The data layers requested from \a md and from the following modifiers.
+ */
+uint64_t BKE_mesh_modifier_cache_key_next(const uint64_t key,
+                                          const ModifierData *md,
+                                          const CustomData_MeshMasks *mask,
+                                          const CustomData_MeshMasks *next_mask)
+{
+  BLI_assert(key != MESH_MODIFIER_CACHE_KEY_NONE);
+
+  uint64_t hash = key;
+  hash = hash_uint64(hash, (uint64_t)md->type);
+  hash = hash_uint64(hash, (uint64_t)md->mode);
+  hash = hash_uint64(hash, (uint64_t)md->flag);
+
+  if (!modifier_settings_hash(md, &hash)) {
+    BLI_assert(!"Modifier type can't be cached");
+    return MESH_MODIFIER_CACHE_KEY_NONE;
+  }
+
+  hash = hash_bytes(hash, mask, sizeof(*mask));
+  hash = hash_bytes(hash, next_mask, sizeof(*next_mask));
+
+  return (hash == MESH_MODIFIER_CACHE_KEY_NONE) ? 1 : hash;
+}
+
+static void modifier_id_link_find(void *user_data,
+                                  Object *UNUSED(ob),
+                                  ID **idpoin,
+                                  int UNUSED(cb_flag))
+{
+  if (*idpoin != NULL) {
+    *(bool *)user_data = true;
+  }
+}
+
+/**
+ * \return True when the result of \a md only depends on its input mesh and settings.
+ */
+bool BKE_mesh_modifier_cache_supported(ModifierData *md, Object *ob)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+
+  /* Only the types whose settings are listed can be hashed. */
+  uint64_t hash = HASH_SEED;
+  if (!modifier_settings_hash(md, &hash)) {
+    return false;
+  }
+
+  bool has_id_link = false;
+  if (mti->foreachIDLink) {
+    mti->foreachIDLink(md, ob, modifier_id_link_find, &has_id_link);
+  }
+  else if (mti->foreachObjectLink) {
+    mti->foreachObjectLink(md, ob, (ObjectWalkFunc)modifier_id_link_find, &has_id_link);
+  }
+  return !has_id_link;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Storage
+ *
+ * Meshes are copied outside of the lock, so evaluations of other objects don't wait for them.
+ * \{ */
+
+typedef struct MeshModifierCacheEntry {
+  struct MeshModifierCacheEntry *next, *prev;
+  SessionUUID session_uuid;
+  uint64_t key;
+  /** Number of evaluations in a row that gave #key, up to #MESH_MODIFIER_CACHE_STORE_REPEAT. */
+  int key_repeat_num;
+  /** Lookups copying #mesh, the last one frees the entry when it was removed meanwhile. */
+  int users;
+  bool is_removed;
+  /** Only stored once #key repeated, NULL before. */
+  Mesh *mesh;
+  size_t mem_size;
+} MeshModifierCacheEntry;
+
+/**
+ * One entry for every modifier, ordered from least to most recently used.
+ */
+static struct {
+  GHash *entries;
+  ListBase lru;
+  size_t mem_size;
+} mesh_modifier_cache = {NULL};
+
+static ThreadMutex mesh_modifier_cache_lock = BLI_MUTEX_INITIALIZER;
+
+static size_t customdata_mem_size(const CustomData *data, const int totelem)
+{
+  size_t mem_size = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    mem_size += (size_t)CustomData_sizeof(data->layers[i].type) * (size_t)totelem;
+  }
+  return mem_size;
+}
+
+static size_t mesh_mem_size(const Mesh *mesh)
+{
+  return sizeof(*mesh) + customdata_mem_size(&mesh->vdata, mesh->totvert) +
+         customdata_mem_size(&mesh->edata, mesh->totedge) +
+         customdata_mem_size(&mesh->fdata, mesh->totface) +
+         customdata_mem_size(&mesh->pdata, mesh->totpoly) +
+         customdata_mem_size(&mesh->ldata, mesh->totloop);
+}
+
+static void cache_entry_free(MeshModifierCacheEntry *entry)
+{
+  if (entry->mesh) {
+    BKE_id_free(NULL, entry->mesh);
+  }
+  MEM_freeN(entry);
+}
+
+/**
+ * Remove \a entry from the cache while the lock is held. It's added to \a r_freed to be freed
+ * after unlocking, unless it's still used by a lookup.
+ */
+static void cache_entry_remove(MeshModifierCacheEntry *entry, ListBase *r_freed)
+{
+  BLI_ghash_remove(mesh_modifier_cache.entries, &entry->session_uuid, NULL, NULL);
+  BLI_remlink(&mesh_modifier_cache.lru, entry);
+  mesh_modifier_cache.mem_size -= entry->mem_size;
+  if (entry->users == 0) {
+    BLI_addtail(r_freed, entry);
+  }
+  else {
+    entry->is_removed = true;
+  }
+}
+
+static void cache_entries_free(ListBase *entries)
+{
+  LISTBASE_FOREACH_MUTABLE (MeshModifierCacheEntry *, entry, entries) {
+    cache_entry_free(entry);
+  }
+  BLI_listbase_clear(entries);
+}
+
+static MeshModifierCacheEntry *cache_entry_find(const ModifierData *md, const uint64_t key)
+{
+  if (mesh_modifier_cache.entries == NULL) {
+    return NULL;
+  }
+  MeshModifierCacheEntry *entry = BLI_ghash_lookup(mesh_modifier_cache.entries,
+                                                   &md->session_uuid);
+  return (entry && entry->key == key && entry->mesh) ? entry : NULL;
+}
+
+bool BKE_mesh_modifier_cache_contains(const ModifierData *md, const uint64_t key)
+{
+  BLI_mutex_lock(&mesh_modifier_cache_lock);
+  const bool found = cache_entry_find(md, key) != NULL;
+  BLI_mutex_unlock(&mesh_modifier_cache_lock);
+  return found;
+}
+
+/**
+ * \return A copy of the result of \a md stored with \a key, or NULL.
+ */
+Mesh *BKE_mesh_modifier_cache_lookup(const ModifierData *md, const uint64_t key)
+{
+  BLI_mutex_lock(&mesh_modifier_cache_lock);
+  MeshModifierCacheEntry *entry = cache_entry_find(md, key);
+  if (entry == NULL) {
+    BLI_mutex_unlock(&mesh_modifier_cache_lock);
+    return NULL;
+  }
+  entry->users++;
+  BLI_remlink(&mesh_modifier_cache.lru, entry);
+  BLI_addtail(&mesh_modifier_cache.lru, entry);
+  BLI_mutex_unlock(&mesh_modifier_cache_lock);
+
+  /* The copy is modified by the following modifiers. */
+  Mesh *mesh = BKE_mesh_copy_for_eval(entry->mesh, false);
+
+  BLI_mutex_lock(&mesh_modifier_cache_lock);
+  entry->users--;
+  const bool do_free = entry->is_removed && entry->users == 0;
+  BLI_mutex_unlock(&mesh_modifier_cache_lock);
+
+  if (do_free) {
+    cache_entry_free(entry);
+  }
+  return mesh;
+}
+
+/**
+ * Report that \a md generated \a mesh for \a key, replacing the previous result of \a md.
+ *
+ * A copy of \a mesh is only stored once the same key was reported
+ * #MESH_MODIFIER_CACHE_STORE_REPEAT times in a row, so results that change with every evaluation
+ * (e.g. during playback) aren't copied.
+ */
+void BKE_mesh_modifier_cache_store(const ModifierData *md, const uint64_t key, const Mesh *mesh)
+{
+  BLI_assert(key != MESH_MODIFIER_CACHE_KEY_NONE);
+  ListBase freed = {NULL, NULL};
+
+  BLI_mutex_lock(&mesh_modifier_cache_lock);
+
+  if (mesh_modifier_cache.entries == NULL) {
+    mesh_modifier_cache.entries = BLI_ghash_new(
+        BLI_session_uuid_ghash_hash, BLI_session_uuid_ghash_compare, __func__);
+  }
+
+  MeshModifierCacheEntry *entry = BLI_ghash_lookup(mesh_modifier_cache.entries,
+                                                   &md->session_uuid);
+  if (entry && entry->key != key) {
+    cache_entry_remove(entry, &freed);
+    entry = NULL;
+  }
+  if (entry == NULL) {
+    entry = MEM_callocN(sizeof(*entry), __func__);
+    entry->session_uuid = md->session_uuid;
+    entry->key = key;
+    BLI_ghash_insert(mesh_modifier_cache.entries, &entry->session_uuid, entry);
+    BLI_addtail(&mesh_modifier_cache.lru, entry);
+  }
+  if (entry->key_repeat_num < MESH_MODIFIER_CACHE_STORE_REPEAT) {
+    entry->key_repeat_num++;
+  }
+  const bool do_store = entry->mesh == NULL &&
+                        entry->key_repeat_num == MESH_MODIFIER_CACHE_STORE_REPEAT;
+
+  BLI_mutex_unlock(&mesh_modifier_cache_lock);
+  cache_entries_free(&freed);
+
+  if (!do_store) {
+    return;
+  }
+  const size_t mem_size = mesh_mem_size(mesh);
+  if (mem_size > MESH_MODIFIER_CACHE_BUDGET / 4) {
+    /* Would push out too many other results. */
+    return;
+  }
+  Mesh *mesh_copy = BKE_mesh_copy_for_eval((Mesh *)mesh, false);
+
+  BLI_mutex_lock(&mesh_modifier_cache_lock);
+
+  /* The entry may have been replaced or freed while copying. */
+  entry = mesh_modifier_cache.entries ?
+              BLI_ghash_lookup(mesh_modifier_cache.entries, &md->session_uuid) :
+              NULL;
+  if (entry && entry->key == key && entry->mesh == NULL) {
+    BLI_remlink(&mesh_modifier_cache.lru, entry);
+    BLI_addtail(&mesh_modifier_cache.lru, entry);
+    while (mesh_modifier_cache.lru.first != entry &&
+           mesh_modifier_cache.mem_size + mem_size > MESH_MODIFIER_CACHE_BUDGET) {
+      cache_entry_remove(mesh_modifier_cache.lru.first, &freed);
+    }
+    entry->mesh = mesh_copy;
+    entry->mem_size = mem_size;
+    mesh_modifier_cache.mem_size += mem_size;
+    mesh_copy = NULL;
+  }
+
+  BLI_mutex_unlock(&mesh_modifier_cache_lock);
+  cache_entries_free(&freed);
+
+  if (mesh_copy) {
+    BKE_id_free(NULL, mesh_copy);
+  }
+}
+
+/**
+ * Free all results, needed when the modifiers they belong to are replaced, e.g. by loading a
+ * file or undo.
+ */
+void BKE_mesh_modifier_cache_clear(void)
+{
+  ListBase freed = {NULL, NULL};
+
+  BLI_mutex_lock(&mesh_modifier_cache_lock);
+  while (mesh_modifier_cache.lru.first) {
+    cache_entry_remove(mesh_modifier_cache.lru.first, &freed);
+  }
+  if (mesh_modifier_cache.entries) {
+    BLI_ghash_free(mesh_modifier_cache.entries, NULL, NULL);
+    mesh_modifier_cache.entries = NULL;
+  }
+  BLI_mutex_unlock(&mesh_modifier_cache_lock);
+
+  cache_entries_free(&freed);
+}
+
+void BKE_mesh_modifier_cache_exit(void)
+{
+  BKE_mesh_modifier_cache_clear();
+}
+
+/** \} */
@@ -0,0 +1,343 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <algorithm>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math_vector.h"
+
+#include "BKE_curveprofile.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_modifier_cache.h"
+#include "BKE_mesh_runtime.h"
+#include "BKE_modifier.h"
+
+#include "DNA_curveprofile_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+
+namespace blender::bke::tests {
+
+class mesh_modifier_cache : public testing::Test {
+ protected:
+  Scene scene_ = {};
+  Object ob_ = {};
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_modifier_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_mesh_modifier_cache_exit();
+  }
+
+  void TearDown() override
+  {
+    BKE_mesh_modifier_cache_clear();
+  }
+
+  uint64_t key_init(Mesh *mesh)
+  {
+    return BKE_mesh_modifier_cache_key_init(&scene_, &ob_, mesh, nullptr, 0, 0, false);
+  }
+
+  static uint64_t key_next(const uint64_t key, const ModifierData *md)
+  {
+    const CustomData_MeshMasks mask = {0};
+    return BKE_mesh_modifier_cache_key_next(key, md, &mask, &mask);
+  }
+};
+
+static Mesh *mesh_new(const int verts_num)
+{
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num, 0, 0, 0, 0);
+  for (int i = 0; i < verts_num; i++) {
+    mesh->mvert[i].co[0] = (float)i;
+  }
+  return mesh;
+}
+
+TEST_F(mesh_modifier_cache, KeyInit)
+{
+  Mesh *mesh = mesh_new(4);
+  const uint64_t key = key_init(mesh);
+  EXPECT_NE(key, MESH_MODIFIER_CACHE_KEY_NONE);
+  EXPECT_EQ(key_init(mesh), key);
+
+  mesh->mvert[2].co[1] = 1.0f;
+  EXPECT_NE(key_init(mesh), key);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(mesh_modifier_cache, KeyNextBevelProfile)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Bevel);
+  BevelModifierData *bmd = (BevelModifierData *)md;
+  ASSERT_NE(bmd->custom_profile, nullptr);
+  EXPECT_TRUE(BKE_mesh_modifier_cache_supported(md, &ob_));
+  const uint64_t key = key_next(1, md);
+
+  /* The profile is hashed by its points, not by its address. */
+  CurveProfile *profile = bmd->custom_profile;
+  bmd->custom_profile = BKE_curveprofile_copy(profile);
+  BKE_curveprofile_free(profile);
+  EXPECT_EQ(key_next(1, md), key);
+
+  bmd->custom_profile->path[0].y += 0.5f;
+  EXPECT_NE(key_next(1, md), key);
+
+  BKE_modifier_free(md);
+}
+
+TEST_F(mesh_modifier_cache, UnlistedTypeUnsupported)
+{
+  /* Bind data is changed without changing its address. */
+  ModifierData *md = BKE_modifier_new(eModifierType_LaplacianDeform);
+  EXPECT_FALSE(BKE_mesh_modifier_cache_supported(md, &ob_));
+  BKE_modifier_free(md);
+
+  /* Bind coordinates are written by the evaluation. */
+  md = BKE_modifier_new(eModifierType_CorrectiveSmooth);
+  EXPECT_FALSE(BKE_mesh_modifier_cache_supported(md, &ob_));
+  BKE_modifier_free(md);
+}
+
+TEST_F(mesh_modifier_cache, KeyNextRuntimeData)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Decimate);
+  EXPECT_TRUE(BKE_mesh_modifier_cache_supported(md, &ob_));
+  const uint64_t key = key_next(1, md);
+
+  /* The face count is written by the evaluation. */
+  DecimateModifierData *dmd = (DecimateModifierData *)md;
+  dmd->face_count = 100;
+  EXPECT_EQ(key_next(1, md), key);
+
+  dmd->percent = 0.25f;
+  EXPECT_NE(key_next(1, md), key);
+
+  BKE_modifier_free(md);
+}
+
+TEST_F(mesh_modifier_cache, HitMissInvalidate)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Triangulate);
+  Mesh *mesh = mesh_new(4);
+  const uint64_t key = key_next(key_init(mesh), md);
+
+  /* Nothing is stored until the key repeated. */
+  EXPECT_EQ(BKE_mesh_modifier_cache_lookup(md, key), nullptr);
+  for (int i = 1; i < MESH_MODIFIER_CACHE_STORE_REPEAT; i++) {
+    BKE_mesh_modifier_cache_store(md, key, mesh);
+    EXPECT_FALSE(BKE_mesh_modifier_cache_contains(md, key));
+  }
+  BKE_mesh_modifier_cache_store(md, key, mesh);
+  EXPECT_TRUE(BKE_mesh_modifier_cache_contains(md, key));
+
+  /* Hit, returning a copy. */
+  Mesh *mesh_cached = BKE_mesh_modifier_cache_lookup(md, key);
+  ASSERT_NE(mesh_cached, nullptr);
+  EXPECT_NE(mesh_cached, mesh);
+  EXPECT_EQ(mesh_cached->totvert, 4);
+  EXPECT_EQ(mesh_cached->mvert[3].co[0], 3.0f);
+  BKE_id_free(nullptr, mesh_cached);
+
+  /* Miss for a changed input. */
+  mesh->mvert[0].co[2] = 1.0f;
+  const uint64_t key_changed = key_next(key_init(mesh), md);
+  EXPECT_NE(key_changed, key);
+  EXPECT_EQ(BKE_mesh_modifier_cache_lookup(md, key_changed), nullptr);
+
+  /* Miss for another modifier with the same key. */
+  ModifierData *md_other = BKE_modifier_new(eModifierType_Triangulate);
+  EXPECT_EQ(BKE_mesh_modifier_cache_lookup(md_other, key), nullptr);
+
+  /* A new result replaces the previous one. */
+  BKE_mesh_modifier_cache_store(md, key_changed, mesh);
+  EXPECT_FALSE(BKE_mesh_modifier_cache_contains(md, key));
+
+  /* Loading a file or undo frees all results. */
+  for (int i = 0; i < MESH_MODIFIER_CACHE_STORE_REPEAT; i++) {
+    BKE_mesh_modifier_cache_store(md, key, mesh);
+  }
+  EXPECT_TRUE(BKE_mesh_modifier_cache_contains(md, key));
+  BKE_mesh_modifier_cache_clear();
+  EXPECT_FALSE(BKE_mesh_modifier_cache_contains(md, key));
+
+  BKE_id_free(nullptr, mesh);
+  BKE_modifier_free(md);
+  BKE_modifier_free(md_other);
+}
+
+/* Number of times each modifier type generated a mesh, counted by wrapping its callback. */
+static int modify_mesh_num[NUM_MODIFIER_TYPES];
+static Mesh *(*modify_mesh_orig[NUM_MODIFIER_TYPES])(ModifierData *md,
+                                                     const ModifierEvalContext *ctx,
+                                                     Mesh *mesh);
+
+static Mesh *modify_mesh_counted(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
+{
+  modify_mesh_num[md->type]++;
+  return modify_mesh_orig[md->type](md, ctx, mesh);
+}
+
+/* Object with a quad, evaluated by a stack of modifiers which don't depend on other IDs. */
+class mesh_modifier_cache_stack : public mesh_modifier_cache {
+ protected:
+  static constexpr ModifierType types_[3] = {
+      eModifierType_Triangulate, eModifierType_EdgeSplit, eModifierType_Array};
+  Main *bmain_;
+  Depsgraph *depsgraph_;
+  ArrayModifierData *amd_;
+
+  void SetUp() override
+  {
+    for (const ModifierType type : types_) {
+      ModifierTypeInfo *mti = (ModifierTypeInfo *)BKE_modifier_get_info(type);
+      modify_mesh_orig[type] = mti->modifyMesh;
+      mti->modifyMesh = modify_mesh_counted;
+      modify_mesh_num[type] = 0;
+    }
+
+    bmain_ = BKE_main_new();
+    depsgraph_ = DEG_graph_new(bmain_, &scene_, nullptr, DAG_EVAL_VIEWPORT);
+
+    Mesh *mesh = BKE_mesh_new_nomain(4, 4, 0, 4, 1);
+    const float co[4][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+    for (int i = 0; i < 4; i++) {
+      copy_v3_v3(mesh->mvert[i].co, co[i]);
+      mesh->medge[i].v1 = i;
+      mesh->medge[i].v2 = (i + 1) % 4;
+      mesh->mloop[i].v = i;
+      mesh->mloop[i].e = i;
+    }
+    mesh->mpoly[0].totloop = 4;
+    ob_.type = OB_MESH;
+    ob_.data = mesh;
+
+    for (const ModifierType type : types_) {
+      BLI_addtail(&ob_.modifiers, BKE_modifier_new(type));
+    }
+    amd_ = (ArrayModifierData *)ob_.modifiers.last;
+    amd_->flags = 0;
+    amd_->count = 3;
+  }
+
+  void TearDown() override
+  {
+    BKE_modifiers_clear_errors(&ob_);
+    LISTBASE_FOREACH_MUTABLE (ModifierData *, md, &ob_.modifiers) {
+      BKE_modifier_free(md);
+    }
+    BKE_id_free(nullptr, ob_.data);
+    DEG_graph_free(depsgraph_);
+    BKE_main_free(bmain_);
+
+    for (const ModifierType type : types_) {
+      ModifierTypeInfo *mti = (ModifierTypeInfo *)BKE_modifier_get_info(type);
+      mti->modifyMesh = modify_mesh_orig[type];
+    }
+    mesh_modifier_cache::TearDown();
+  }
+
+  Mesh *evaluate()
+  {
+    return mesh_create_eval_final_view(depsgraph_, &scene_, &ob_, &CD_MASK_BAREMESH);
+  }
+
+  /* Evaluate and compare the result with an evaluation without the cache. */
+  void evaluate_and_compare()
+  {
+    Mesh *result = evaluate();
+    ASSERT_NE(result, nullptr);
+
+    BKE_mesh_modifier_cache_clear();
+    Mesh *expected = evaluate();
+    EXPECT_EQ(result->totvert, expected->totvert);
+    EXPECT_EQ(result->totpoly, expected->totpoly);
+    EXPECT_EQ(result->totloop, expected->totloop);
+    for (int i = 0; i < std::min(result->totvert, expected->totvert); i++) {
+      EXPECT_V3_NEAR(result->mvert[i].co, expected->mvert[i].co, 0.0f);
+    }
+
+    BKE_id_free(nullptr, result);
+    BKE_id_free(nullptr, expected);
+  }
+};
+
+TEST_F(mesh_modifier_cache_stack, ResumeAfterUnchanged)
+{
+  /* The results are stored once their keys repeated. */
+  for (int i = 0; i < MESH_MODIFIER_CACHE_STORE_REPEAT; i++) {
+    Mesh *result = evaluate();
+    EXPECT_EQ(result->totvert, 12);
+    EXPECT_EQ(result->totpoly, 6);
+    BKE_id_free(nullptr, result);
+  }
+  for (const ModifierType type : types_) {
+    EXPECT_EQ(modify_mesh_num[type], MESH_MODIFIER_CACHE_STORE_REPEAT);
+  }
+
+  /* Only the changed last modifier is evaluated again. */
+  amd_->count = 4;
+  Mesh *result = evaluate();
+  EXPECT_EQ(result->totvert, 16);
+  EXPECT_EQ(result->totpoly, 8);
+  BKE_id_free(nullptr, result);
+  EXPECT_EQ(modify_mesh_num[eModifierType_Triangulate], MESH_MODIFIER_CACHE_STORE_REPEAT);
+  EXPECT_EQ(modify_mesh_num[eModifierType_EdgeSplit], MESH_MODIFIER_CACHE_STORE_REPEAT);
+  EXPECT_EQ(modify_mesh_num[eModifierType_Array], MESH_MODIFIER_CACHE_STORE_REPEAT + 1);
+
+  /* Resuming gives the same result as evaluating the whole stack. */
+  for (int i = 0; i < MESH_MODIFIER_CACHE_STORE_REPEAT; i++) {
+    BKE_id_free(nullptr, evaluate());
+  }
+  amd_->count = 2;
+  evaluate_and_compare();
+}
+
+TEST_F(mesh_modifier_cache_stack, ChangedInput)
+{
+  for (int i = 0; i < MESH_MODIFIER_CACHE_STORE_REPEAT; i++) {
+    BKE_id_free(nullptr, evaluate());
+  }
+
+  /* All modifiers are evaluated again for a changed mesh. */
+  Mesh *mesh = (Mesh *)ob_.data;
+  mesh->mvert[2].co[2] = 0.5f;
+  const int evaluated_num = modify_mesh_num[eModifierType_Triangulate];
+  evaluate_and_compare();
+  for (const ModifierType type : types_) {
+    EXPECT_EQ(modify_mesh_num[type], evaluated_num + 2);
+  }
+}
+
+}  // namespace blender::bke::tests
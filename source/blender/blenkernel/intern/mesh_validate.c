@@ -37,6 +37,7 @@
 #include "BLI_edgehash.h"
 #include "BLI_math_base.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.h"
@@ -1523,22 +1524,163 @@ void BKE_mesh_calc_edges_legacy(Mesh *me, const bool use_old)
   BKE_mesh_strip_loose_faces(me);
 }
 
+/* Below this number of loops, all edges are calculated in a single bucket without threading. */
+#define MESH_CALC_EDGES_THREADED_LOOPS_MIN 8192
+
+typedef struct MeshCalcEdgesData {
+  MLoop *mloop;
+  const MPoly *mpoly;
+  int totpoly;
+
+  /** Existing edges, only set when updating. */
+  const MEdge *medge_orig;
+  int totedge_orig;
+
+  /** Edges are partitioned into buckets by a hash of their lowest vertex index. */
+  EdgeHash **edgehashes;
+  uint buckets_mask;
+  uint eh_reserve;
+
+  /**
+   * Indexed by the position at which loops are visited (polygon by polygon, which isn't the
+   * order of the loops when polygons aren't sorted by their loop start), tagged for the first use
+   * of an edge, then replaced by the index of that edge. Not needed with a single bucket, its
+   * edges are numbered while they are added.
+   */
+  int *first_use_edges;
+  int totedge_new;
+
+  MEdge *medge;
+  short ed_flag;
+} MeshCalcEdgesData;
+
+BLI_INLINE uint mesh_calc_edges_bucket(const MeshCalcEdgesData *data, const uint v1, const uint v2)
+{
+  /* Fibonacci hashing, so neighbor vertices don't all end up in the same bucket. */
+  return ((MIN2(v1, v2) * 2654435761u) >> 16) & data->buckets_mask;
+}
+
+static void mesh_calc_edges_bucket_build_cb(void *__restrict userdata,
+                                            const int bucket,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshCalcEdgesData *data = userdata;
+  const MPoly *mp;
+  int i;
+
+  EdgeHash *eh = BLI_edgehash_new_ex(__func__, data->eh_reserve);
+  data->edgehashes[bucket] = eh;
+
+  /* Assume existing edges are valid,
+   * useful when adding more faces and generating edges from them. */
+  for (i = 0; i < data->totedge_orig; i++) {
+    const MEdge *med = &data->medge_orig[i];
+    if (mesh_calc_edges_bucket(data, med->v1, med->v2) == (uint)bucket) {
+      void **val_p;
+      if (!BLI_edgehash_ensure_p(eh, med->v1, med->v2, &val_p)) {
+        *val_p = POINTER_FROM_INT(i);
+      }
+    }
+  }
+
+  /* Every bucket walks over all loops in the same order, but only adds its own edges. */
+  int use_index = 0;
+  for (mp = data->mpoly, i = 0; i < data->totpoly; mp++, i++) {
+    const MLoop *l = &data->mloop[mp->loopstart];
+    uint v_prev = l[mp->totloop - 1].v;
+    for (int j = 0; j < mp->totloop; j++, use_index++) {
+      const uint v = l[j].v;
+      if (v_prev != v && mesh_calc_edges_bucket(data, v_prev, v) == (uint)bucket) {
+        void **val_p;
+        if (!BLI_edgehash_ensure_p(eh, v_prev, v, &val_p)) {
+          if (data->first_use_edges) {
+            *val_p = POINTER_FROM_INT(data->totedge_orig + use_index);
+            data->first_use_edges[use_index] = 1;
+          }
+          else {
+            *val_p = POINTER_FROM_INT(data->totedge_orig + data->totedge_new++);
+          }
+        }
+      }
+      v_prev = v;
+    }
+  }
+}
+
+static void mesh_calc_edges_bucket_write_cb(void *__restrict userdata,
+                                            const int bucket,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshCalcEdgesData *data = userdata;
+  EdgeHashIterator *ehi;
+
+  for (ehi = BLI_edgehashIterator_new(data->edgehashes[bucket]);
+       BLI_edgehashIterator_isDone(ehi) == false;
+       BLI_edgehashIterator_step(ehi)) {
+    int med_index = POINTER_AS_INT(BLI_edgehashIterator_getValue(ehi));
+    /* Existing edges are copied as a whole, see #BKE_mesh_calc_edges. */
+    if (med_index >= data->totedge_orig) {
+      if (data->first_use_edges) {
+        med_index = data->first_use_edges[med_index - data->totedge_orig];
+      }
+      MEdge *med = &data->medge[med_index];
+      BLI_edgehashIterator_getKey(ehi, &med->v1, &med->v2);
+      med->flag = data->ed_flag;
+    }
+
+    /* store the new edge index in the hash value */
+    BLI_edgehashIterator_setValue(ehi, POINTER_FROM_INT(med_index));
+  }
+  BLI_edgehashIterator_free(ehi);
+}
+
+static void mesh_calc_edges_loops_assign_cb(void *__restrict userdata,
+                                            const int mp_index,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshCalcEdgesData *data = userdata;
+  const MPoly *mp = &data->mpoly[mp_index];
+  MLoop *l = &data->mloop[mp->loopstart];
+  MLoop *l_prev = (l + (mp->totloop - 1));
+  int med_index;
+
+  for (int j = 0; j < mp->totloop; j++, l++) {
+    /* Lookup hashed edge index, if it's valid. */
+    if (l_prev->v != l->v) {
+      EdgeHash *eh = data->edgehashes[mesh_calc_edges_bucket(data, l_prev->v, l->v)];
+      med_index = POINTER_AS_INT(BLI_edgehash_lookup(eh, l_prev->v, l->v));
+    }
+    else {
+      /* This is an invalid edge; normally this does not happen in Blender, but it can be part
+       * of an imported mesh with invalid geometry. See T76514. */
+      med_index = 0;
+    }
+    l_prev->e = med_index;
+    l_prev = l;
+  }
+}
+
+static void mesh_calc_edges_bucket_free_cb(void *__restrict userdata,
+                                           const int bucket,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshCalcEdgesData *data = userdata;
+  BLI_edgehash_free(data->edgehashes[bucket], NULL);
+}
+
 /**
  * Calculate edges from polygons
  *
+ * Edges are stored in the order they are first used by the polygons (after the existing edges
+ * when updating), independently of the number of threads used to calculate them.
+ *
  * \param mesh: The mesh to add edges into
  * \param update: When true create new edges co-exist
  */
 void BKE_mesh_calc_edges(Mesh *mesh, bool update, const bool select)
 {
   CustomData edata;
-  EdgeHashIterator *ehi;
-  MPoly *mp;
-  MEdge *med, *med_orig;
-  EdgeHash *eh;
-  unsigned int eh_reserve;
-  int i, totedge, totpoly = mesh->totpoly;
-  int med_index;
+  int i, totedge;
   /* select for newly created meshes which are selected [#25595] */
   const short ed_flag = (ME_EDGEDRAW | ME_EDGERENDER) | (select ? SELECT : 0);
 
@@ -1546,86 +1688,91 @@ void BKE_mesh_calc_edges(Mesh *mesh, bool update, const bool select)
     update = false;
   }
 
-  eh_reserve = max_ii(update ? mesh->totedge : 0, BLI_EDGEHASH_SIZE_GUESS_FROM_POLYS(totpoly));
-  eh = BLI_edgehash_new_ex(__func__, eh_reserve);
-
-  if (update) {
-    /* assume existing edges are valid
-     * useful when adding more faces and generating edges from them */
-    med = mesh->medge;
-    for (i = 0; i < mesh->totedge; i++, med++) {
-      BLI_edgehash_insert(eh, med->v1, med->v2, med);
+  /* Each bucket is built by its own task, so use as many as threads. Without TBB tasks run one
+   * after the other, more buckets would only add work. */
+#ifdef WITH_TBB
+  const int threads_num = BLI_task_scheduler_num_threads();
+#else
+  const int threads_num = 1;
+#endif
+  const int buckets_num = (threads_num > 1 &&
+                           mesh->totloop >= MESH_CALC_EDGES_THREADED_LOOPS_MIN) ?
+                              power_of_2_max_i(threads_num) :
+                              1;
+
+  /* Number of loops visited by the buckets, which may differ from the number of loops in invalid
+   * meshes. */
+  int loops_visit_num = 0;
+  if (buckets_num > 1) {
+    for (i = 0; i < mesh->totpoly; i++) {
+      loops_visit_num += mesh->mpoly[i].totloop;
     }
   }
-
-  /* mesh loops (bmesh only) */
-  for (mp = mesh->mpoly, i = 0; i < totpoly; mp++, i++) {
-    MLoop *l = &mesh->mloop[mp->loopstart];
-    int j, v_prev = (l + (mp->totloop - 1))->v;
-    for (j = 0; j < mp->totloop; j++, l++) {
-      if (v_prev != l->v) {
-        void **val_p;
-        if (!BLI_edgehash_ensure_p(eh, v_prev, l->v, &val_p)) {
-          *val_p = NULL;
-        }
+  const uint eh_reserve = max_ii(update ? mesh->totedge : 0,
+                                 BLI_EDGEHASH_SIZE_GUESS_FROM_POLYS(mesh->totpoly));
+
+  MeshCalcEdgesData data = {
+      .mloop = mesh->mloop,
+      .mpoly = mesh->mpoly,
+      .totpoly = mesh->totpoly,
+      .medge_orig = update ? mesh->medge : NULL,
+      .totedge_orig = update ? mesh->totedge : 0,
+      .edgehashes = MEM_malloc_arrayN((size_t)buckets_num, sizeof(EdgeHash *), __func__),
+      .buckets_mask = (uint)buckets_num - 1,
+      .eh_reserve = eh_reserve / (uint)buckets_num,
+      .first_use_edges = (buckets_num > 1) ?
+                             MEM_calloc_arrayN((size_t)loops_visit_num, sizeof(int), __func__) :
+                             NULL,
+      .ed_flag = ed_flag,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (buckets_num > 1);
+
+  BLI_task_parallel_range(0, buckets_num, &data, mesh_calc_edges_bucket_build_cb, &settings);
+
+  /* New edges are numbered in the order of their first use. */
+  totedge = data.totedge_orig + data.totedge_new;
+  if (data.first_use_edges) {
+    for (i = 0; i < loops_visit_num; i++) {
+      if (data.first_use_edges[i]) {
+        data.first_use_edges[i] = totedge++;
       }
-      v_prev = l->v;
     }
   }
 
-  totedge = BLI_edgehash_len(eh);
-
   /* write new edges into a temporary CustomData */
   CustomData_reset(&edata);
   CustomData_add_layer(&edata, CD_MEDGE, CD_CALLOC, NULL, totedge);
 
-  med = CustomData_get_layer(&edata, CD_MEDGE);
-  for (ehi = BLI_edgehashIterator_new(eh), i = 0; BLI_edgehashIterator_isDone(ehi) == false;
-       BLI_edgehashIterator_step(ehi), ++i, ++med) {
-    if (update && (med_orig = BLI_edgehashIterator_getValue(ehi))) {
-      *med = *med_orig; /* copy from the original */
-    }
-    else {
-      BLI_edgehashIterator_getKey(ehi, &med->v1, &med->v2);
-      med->flag = ed_flag;
-    }
-
-    /* store the new edge index in the hash value */
-    BLI_edgehashIterator_setValue(ehi, POINTER_FROM_INT(i));
+  data.medge = CustomData_get_layer(&edata, CD_MEDGE);
+  if (update) {
+    memcpy(data.medge, mesh->medge, sizeof(*data.medge) * (size_t)mesh->totedge);
   }
-  BLI_edgehashIterator_free(ehi);
+  BLI_task_parallel_range(0, buckets_num, &data, mesh_calc_edges_bucket_write_cb, &settings);
 
   if (mesh->totpoly) {
     /* second pass, iterate through all loops again and assign
      * the newly created edges to them. */
-    for (mp = mesh->mpoly, i = 0; i < mesh->totpoly; mp++, i++) {
-      MLoop *l = &mesh->mloop[mp->loopstart];
-      MLoop *l_prev = (l + (mp->totloop - 1));
-      int j;
-      for (j = 0; j < mp->totloop; j++, l++) {
-        /* Lookup hashed edge index, if it's valid. */
-        if (l_prev->v != l->v) {
-          med_index = POINTER_AS_INT(BLI_edgehash_lookup(eh, l_prev->v, l->v));
-        }
-        else {
-          /* This is an invalid edge; normally this does not happen in Blender, but it can be part
-           * of an imported mesh with invalid geometry. See T76514. */
-          med_index = 0;
-        }
-        l_prev->e = med_index;
-        l_prev = l;
-      }
-    }
+    TaskParallelSettings poly_settings;
+    BLI_parallel_range_settings_defaults(&poly_settings);
+    poly_settings.use_threading = (buckets_num > 1);
+    poly_settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(
+        0, mesh->totpoly, &data, mesh_calc_edges_loops_assign_cb, &poly_settings);
   }
 
+  BLI_task_parallel_range(0, buckets_num, &data, mesh_calc_edges_bucket_free_cb, &settings);
+  MEM_freeN(data.edgehashes);
+  MEM_SAFE_FREE(data.first_use_edges);
+
   /* free old CustomData and assign new one */
   CustomData_free(&mesh->edata, mesh->totedge);
   mesh->edata = edata;
   mesh->totedge = totedge;
 
   mesh->medge = CustomData_get_layer(&mesh->edata, CD_MEDGE);
-
-  BLI_edgehash_free(eh, NULL);
 }
 
 void BKE_mesh_calc_edges_loose(Mesh *mesh)
@@ -0,0 +1,185 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_edgehash.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+class mesh_calc_edges : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/**
+ * Serial version of #BKE_mesh_calc_edges: existing edges first, then new edges in the order the
+ * polygons use them.
+ */
+static void calc_edges_reference(const Mesh *mesh,
+                                 const bool update,
+                                 MEdge **r_medge,
+                                 int *r_totedge,
+                                 int *r_loop_edges)
+{
+  EdgeHash *eh = BLI_edgehash_new(__func__);
+  const int totedge_orig = update ? mesh->totedge : 0;
+  int totedge = totedge_orig;
+
+  for (int i = 0; i < totedge_orig; i++) {
+    void **val_p;
+    if (!BLI_edgehash_ensure_p(eh, mesh->medge[i].v1, mesh->medge[i].v2, &val_p)) {
+      *val_p = POINTER_FROM_INT(i);
+    }
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mesh->mpoly[i];
+    const MLoop *l = &mesh->mloop[mp->loopstart];
+    uint v_prev = l[mp->totloop - 1].v;
+    for (int j = 0; j < mp->totloop; j++) {
+      void **val_p;
+      if (v_prev != l[j].v && !BLI_edgehash_ensure_p(eh, v_prev, l[j].v, &val_p)) {
+        *val_p = POINTER_FROM_INT(totedge++);
+      }
+      v_prev = l[j].v;
+    }
+  }
+
+  MEdge *medge = (MEdge *)MEM_calloc_arrayN((size_t)totedge, sizeof(MEdge), __func__);
+  if (update) {
+    memcpy(medge, mesh->medge, sizeof(MEdge) * (size_t)totedge_orig);
+  }
+  EdgeHashIterator *ehi = BLI_edgehashIterator_new(eh);
+  for (; !BLI_edgehashIterator_isDone(ehi); BLI_edgehashIterator_step(ehi)) {
+    const int index = POINTER_AS_INT(BLI_edgehashIterator_getValue(ehi));
+    if (index >= totedge_orig) {
+      BLI_edgehashIterator_getKey(ehi, &medge[index].v1, &medge[index].v2);
+      medge[index].flag = ME_EDGEDRAW | ME_EDGERENDER;
+    }
+  }
+  BLI_edgehashIterator_free(ehi);
+
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mesh->mpoly[i];
+    const MLoop *l = &mesh->mloop[mp->loopstart];
+    for (int j = 0; j < mp->totloop; j++) {
+      const uint v = l[j].v;
+      const uint v_next = l[(j + 1) % mp->totloop].v;
+      r_loop_edges[mp->loopstart + j] = (v != v_next) ?
+                                            POINTER_AS_INT(BLI_edgehash_lookup(eh, v, v_next)) :
+                                            0;
+    }
+  }
+
+  BLI_edgehash_free(eh, nullptr);
+  *r_medge = medge;
+  *r_totedge = totedge;
+}
+
+/**
+ * Random polygons with shared vertices, stored in a shuffled order so the loop order differs
+ * from the order the polygons are visited in.
+ */
+static Mesh *random_mesh(const int polys_num, const int edges_num, const uint seed)
+{
+  const int verts_num = polys_num;
+  RNG *rng = BLI_rng_new(seed);
+
+  int *poly_sizes = (int *)MEM_malloc_arrayN((size_t)polys_num, sizeof(int), __func__);
+  int loops_num = 0;
+  for (int i = 0; i < polys_num; i++) {
+    poly_sizes[i] = 3 + BLI_rng_get_int(rng) % 4;
+    loops_num += poly_sizes[i];
+  }
+
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num, edges_num, 0, loops_num, polys_num);
+  int loopstart = 0;
+  for (int i = 0; i < polys_num; i++) {
+    mesh->mpoly[i].loopstart = loopstart;
+    mesh->mpoly[i].totloop = poly_sizes[i];
+    for (int j = 0; j < poly_sizes[i]; j++) {
+      /* Mostly nearby vertices, so edges are shared. Some loops repeat their vertex. */
+      mesh->mloop[loopstart + j].v = (uint)((i + BLI_rng_get_int(rng) % 8) % verts_num);
+    }
+    loopstart += poly_sizes[i];
+  }
+  BLI_rng_shuffle_array(rng, mesh->mpoly, sizeof(MPoly), (uint)polys_num);
+
+  for (int i = 0; i < edges_num; i++) {
+    mesh->medge[i].v1 = (uint)(BLI_rng_get_int(rng) % verts_num);
+    mesh->medge[i].v2 = (mesh->medge[i].v1 + 1 + (uint)BLI_rng_get_int(rng) % 4) % (uint)verts_num;
+    mesh->medge[i].flag = ME_EDGEDRAW;
+  }
+
+  MEM_freeN(poly_sizes);
+  BLI_rng_free(rng);
+  return mesh;
+}
+
+static void calc_edges_test(const int polys_num, const int edges_num, const bool update)
+{
+  Mesh *mesh = random_mesh(polys_num, edges_num, (uint)polys_num);
+
+  MEdge *medge_ref;
+  int totedge_ref;
+  int *loop_edges_ref = (int *)MEM_malloc_arrayN((size_t)mesh->totloop, sizeof(int), __func__);
+  calc_edges_reference(mesh, update, &medge_ref, &totedge_ref, loop_edges_ref);
+
+  BKE_mesh_calc_edges(mesh, update, false);
+
+  ASSERT_EQ(mesh->totedge, totedge_ref);
+  EXPECT_EQ(memcmp(mesh->medge, medge_ref, sizeof(MEdge) * (size_t)totedge_ref), 0);
+  for (int i = 0; i < mesh->totloop; i++) {
+    EXPECT_EQ(mesh->mloop[i].e, (uint)loop_edges_ref[i]);
+  }
+
+  MEM_freeN(medge_ref);
+  MEM_freeN(loop_edges_ref);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(mesh_calc_edges, Small)
+{
+  calc_edges_test(100, 0, false);
+}
+
+TEST_F(mesh_calc_edges, Large)
+{
+  /* Enough loops for the edges to be calculated in multiple buckets when threads are used. */
+  calc_edges_test(20000, 0, false);
+}
+
+TEST_F(mesh_calc_edges, LargeUpdate)
+{
+  calc_edges_test(20000, 1000, true);
+}
+
+}  // namespace blender::bke::tests
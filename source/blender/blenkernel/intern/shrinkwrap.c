@@ -352,53 +352,59 @@ void BKE_shrinkwrap_compute_boundary_data(struct Mesh *mesh)
  * it builds a kdtree of vertexs we can attach to and then
  * for each vertex performs a nearest vertex search on the tree
  */
-static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
-                                                 const int i,
-                                                 const TaskParallelTLS *__restrict tls)
-{
-  ShrinkwrapCalcCBData *data = userdata;
+typedef struct ShrinkwrapNearestVertexData {
+  ShrinkwrapCalcData *calc;
 
+  /* Vertices in tree coordinates and their weights, for all vertices. */
+  float (*tree_co)[3];
+  float *weights;
+  BVHTreeNearest *nearest;
+} ShrinkwrapNearestVertexData;
+
+static void shrinkwrap_calc_nearest_vertex_gather_cb(void *__restrict userdata,
+                                                     const int i,
+                                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapNearestVertexData *data = userdata;
   ShrinkwrapCalcData *calc = data->calc;
-  BVHTreeFromMesh *treeData = &data->tree->treeData;
-  BVHTreeNearest *nearest = tls->userdata_chunk;
+  BVHTreeNearest *nearest = &data->nearest[i];
 
-  float *co = calc->vertexCos[i];
-  float tmp_co[3];
   float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
 
   if (calc->invert_vgroup) {
     weight = 1.0f - weight;
   }
 
-  if (weight == 0.0f) {
-    return;
-  }
+  data->weights[i] = weight;
 
   /* Convert the vertex to tree coordinates */
   if (calc->vert) {
-    copy_v3_v3(tmp_co, calc->vert[i].co);
+    copy_v3_v3(data->tree_co[i], calc->vert[i].co);
   }
   else {
-    copy_v3_v3(tmp_co, co);
+    copy_v3_v3(data->tree_co[i], calc->vertexCos[i]);
   }
-  BLI_space_transform_apply(&calc->local2target, tmp_co);
+  BLI_space_transform_apply(&calc->local2target, data->tree_co[i]);
 
-  /* Use local proximity heuristics (to reduce the nearest search)
-   *
-   * If we already had an hit before.. we assume this vertex is going to have a close hit to that
-   * other vertex so we can initiate the "nearest.dist" with the expected value to that last hit.
-   * This will lead in pruning of the search tree. */
-  if (nearest->index != -1) {
-    nearest->dist_sq = len_squared_v3v3(tmp_co, nearest->co);
-  }
-  else {
-    nearest->dist_sq = FLT_MAX;
-  }
+  /* A zero search distance makes the query of an unaffected vertex find nothing. */
+  nearest->index = -1;
+  nearest->dist_sq = (weight == 0.0f) ? 0.0f : FLT_MAX;
+}
 
-  BLI_bvhtree_find_nearest(treeData->tree, tmp_co, nearest, treeData->nearest_callback, treeData);
+static void shrinkwrap_calc_nearest_vertex_apply_cb(void *__restrict userdata,
+                                                    const int i,
+                                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapNearestVertexData *data = userdata;
+  ShrinkwrapCalcData *calc = data->calc;
+  const BVHTreeNearest *nearest = &data->nearest[i];
 
   /* Found the nearest vertex */
   if (nearest->index != -1) {
+    float *co = calc->vertexCos[i];
+    float weight = data->weights[i];
+    float tmp_co[3];
+
     /* Adjusting the vertex weight,
      * so that after interpolating it keeps a certain distance from the nearest position */
     if (nearest->dist_sq > FLT_EPSILON) {
@@ -416,23 +422,38 @@ static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
 
 static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
 {
-  BVHTreeNearest nearest = NULL_BVHTreeNearest;
+  BVHTreeFromMesh *treeData = &calc->tree->treeData;
 
-  /* Setup nearest */
-  nearest.index = -1;
-  nearest.dist_sq = FLT_MAX;
-
-  ShrinkwrapCalcCBData data = {
+  ShrinkwrapNearestVertexData data = {
       .calc = calc,
-      .tree = calc->tree,
+      .tree_co = MEM_malloc_arrayN((size_t)calc->numVerts, sizeof(*data.tree_co), __func__),
+      .weights = MEM_malloc_arrayN((size_t)calc->numVerts, sizeof(*data.weights), __func__),
+      .nearest = MEM_malloc_arrayN((size_t)calc->numVerts, sizeof(*data.nearest), __func__),
   };
+
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
-  settings.userdata_chunk = &nearest;
-  settings.userdata_chunk_size = sizeof(nearest);
+
   BLI_task_parallel_range(
-      0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_cb_ex, &settings);
+      0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_gather_cb, &settings);
+
+  /* The batch orders the queries so that nearby vertices are searched after each other, the
+   * previous hit then limits the search radius. */
+  BLI_bvhtree_find_nearest_batch(treeData->tree,
+                                 (const float(*)[3])data.tree_co,
+                                 calc->numVerts,
+                                 data.nearest,
+                                 treeData->nearest_callback,
+                                 treeData,
+                                 0);
+
+  BLI_task_parallel_range(
+      0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_apply_cb, &settings);
+
+  MEM_freeN(data.tree_co);
+  MEM_freeN(data.weights);
+  MEM_freeN(data.nearest);
 }
 
 /*
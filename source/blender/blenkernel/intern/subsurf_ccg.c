@@ -44,6 +44,7 @@
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
+#include "BLI_array.h"
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_edgehash.h"
@@ -65,10 +66,6 @@
 #include "BKE_scene.h"
 #include "BKE_subsurf.h"
 
-#ifndef USE_DYNSIZE
-#  include "BLI_array.h"
-#endif
-
 #include "CCGSubSurf.h"
 
 /* assumes MLoop's are laid out 4 for each poly, in order */
@@ -2014,6 +2011,9 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
   BLI_array_declare(loopidx);
   BLI_array_declare(vertidx);
 #endif
+  /* Face vertex indices repeated for every vertex of a grid row. */
+  int *vertidx_row = NULL;
+  BLI_array_declare(vertidx_row);
   int loopindex, loopindex2;
   int edgeSize;
   int gridSize;
@@ -2090,6 +2090,12 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
       vertidx[s] = POINTER_AS_INT(ccgSubSurf_getVertVertHandle(v));
     }
 
+    BLI_array_clear(vertidx_row);
+    BLI_array_grow_items(vertidx_row, numVerts * (gridFaces - 1));
+    for (x = 1; x < gridFaces; x++) {
+      memcpy(&vertidx_row[(x - 1) * numVerts], vertidx, sizeof(int) * (size_t)numVerts);
+    }
+
     /*I think this is for interpolating the center vert?*/
     w2 = w;  // + numVerts*(g2_wid-1) * (g2_wid-1); //numVerts*((g2_wid-1) * g2_wid+g2_wid-1);
     DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2, numVerts, vertNum);
@@ -2100,12 +2106,18 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 
     vertNum++;
 
-    /*interpolate per-vert data*/
+    /* Interpolate per-vert data, the weights of a grid row are stored contiguously. */
     for (s = 0; s < numVerts; s++) {
-      for (x = 1; x < gridFaces; x++) {
-        w2 = w + s * numVerts * g2_wid * g2_wid + x * numVerts;
-        DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2, numVerts, vertNum);
+      w2 = w + s * numVerts * g2_wid * g2_wid + numVerts;
+      CustomData_interp_n(&dm->vertData,
+                          &ccgdm->dm.vertData,
+                          vertidx_row,
+                          w2,
+                          numVerts,
+                          vertNum,
+                          gridFaces - 1);
 
+      for (x = 1; x < gridFaces; x++) {
         if (vertOrigIndex) {
           *vertOrigIndex = ORIGINDEX_NONE;
           vertOrigIndex++;
@@ -2118,10 +2130,16 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
     /*interpolate per-vert data*/
     for (s = 0; s < numVerts; s++) {
       for (y = 1; y < gridFaces; y++) {
-        for (x = 1; x < gridFaces; x++) {
-          w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-          DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2, numVerts, vertNum);
+        w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + 1) * numVerts;
+        CustomData_interp_n(&dm->vertData,
+                            &ccgdm->dm.vertData,
+                            vertidx_row,
+                            w2,
+                            numVerts,
+                            vertNum,
+                            gridFaces - 1);
 
+        for (x = 1; x < gridFaces; x++) {
           if (vertOrigIndex) {
             *vertOrigIndex = ORIGINDEX_NONE;
             vertOrigIndex++;
@@ -2279,6 +2297,7 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
   BLI_array_free(vertidx);
   BLI_array_free(loopidx);
 #endif
+  BLI_array_free(vertidx_row);
   free_ss_weights(&wtable);
 
   BLI_assert(vertNum == ccgSubSurf_getNumFinalVerts(ss));
@@ -20,6 +20,7 @@
 #include <string.h> /* for memset() */
 
 struct ListBase;
+struct MemArena;
 
 /** \file
  * \ingroup bli
@@ -115,12 +116,23 @@ ThreadMutex *BLI_task_pool_user_mutex(TaskPool *pool);
 
 /* Parallel for routines */
 
+/* Per-thread scratch memory, see #BLI_task_parallel_scratch_alloc. */
+typedef struct TaskParallelScratch {
+  /* Created on first use, so loops that never ask for scratch memory don't pay for it. */
+  struct MemArena *arena;
+  /* Allocations since the arena was last cleared. */
+  uint64_t allocations_num;
+} TaskParallelScratch;
+
 /* Per-thread specific data passed to the callback. */
 typedef struct TaskParallelTLS {
   /* Copy of user-specifier chunk, which is copied from original chunk to all
    * worker threads. This is similar to OpenMP's firstprivate.
    */
   void *userdata_chunk;
+  /* Scratch memory of the worker thread running the callback,
+   * NULL when the loop doesn't support it. */
+  TaskParallelScratch *scratch;
 } TaskParallelTLS;
 
 typedef void (*TaskParallelRangeFunc)(void *__restrict userdata,
@@ -233,6 +245,19 @@ BLI_INLINE void BLI_parallel_range_settings_defaults(TaskParallelSettings *setti
   settings->min_iter_per_thread = 0;
 }
 
+/* Temporary memory for use within a single callback of #BLI_task_parallel_range or
+ * #BLI_task_parallel_iterator, as a cheaper alternative to #MEM_mallocN / #MEM_freeN pairs.
+ * The memory is owned by the worker thread and reused by the next callback it runs,
+ * so it must not be freed nor kept around after the callback returns. */
+void *BLI_task_parallel_scratch_alloc(const TaskParallelTLS *__restrict tls, size_t size);
+void *BLI_task_parallel_scratch_calloc(const TaskParallelTLS *__restrict tls, size_t size);
+/* Totals since startup, useful to measure how many heap allocations scratch memory saves. */
+void BLI_task_parallel_scratch_stats_get(uint64_t *r_allocations_num, uint64_t *r_arenas_num);
+
+/* Used by the parallel loop implementations. */
+void BLI_task_parallel_scratch_iter_end(TaskParallelScratch *scratch);
+void BLI_task_parallel_scratch_free(TaskParallelScratch *scratch);
+
 /* Don't use this, store any thread specific data in tls->userdata_chunk instead.
  * Only here for code to be removed. */
 int BLI_task_parallel_thread_id(const TaskParallelTLS *tls);
@@ -201,6 +201,11 @@ void BLI_thread_queue_nowait(ThreadQueue *queue);
 void BLI_thread_put_process_on_fast_node(void);
 void BLI_thread_put_thread_on_fast_node(void);
 
+/* Spread task scheduler worker threads over all NUMA nodes. */
+void BLI_system_numa_placement_set(bool use_placement);
+bool BLI_system_numa_placement_get(void);
+void BLI_thread_put_thread_on_node_for_index(int thread_index);
+
 #ifdef __cplusplus
 }
 #endif
@@ -88,6 +88,9 @@ typedef struct BVHNode {
   int index;      /* face, edge, vertex index */
   char totnode;   /* how many nodes are used, used for speedup */
   char main_axis; /* Axis used to split this node */
+  /* Least overlap of the children since the leafs were last partitioned (in 1/255 steps),
+   * see #BVH_UPDATE_REBUILD_DEGENERATE. */
+  unsigned char overlap_min;
 } BVHNode;
 
 /* keep under 26 bytes for speed purposes */
@@ -673,6 +676,15 @@ static void split_leafs(BVHNode **leafs_array,
   }
 }
 
+/* Surface area of the bounds along the x, y and z axes. */
+static float bv_surface_area(const float bv[6])
+{
+  const float dx = bv[1] - bv[0];
+  const float dy = bv[3] - bv[2];
+  const float dz = bv[5] - bv[4];
+  return dx * dy + dy * dz + dz * dx;
+}
+
 typedef struct BVHDivNodesData {
   const BVHTree *tree;
   BVHNode *branches_array;
@@ -710,6 +722,7 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
 
   /* Save split axis (this can be used on ray-tracing to speedup the query time) */
   parent->main_axis = split_axis / 2;
+  parent->overlap_min = 0;
 
   /* Split the children along the split_axis, note: its not needed to sort the whole leafs array
    * Only to assure that the elements are partitioned on a way that each child takes the elements
@@ -1021,21 +1034,203 @@ bool BLI_bvhtree_update_node(
   return true;
 }
 
+/* Children of a freshly balanced branch barely overlap. When the summed surface area of the
+ * children comes close to that many copies of the branch, the split no longer separates them. */
+#define BVH_DEGENERATE_AREA_FACTOR 0.8f
+/* Some geometry overlaps no matter how it is split (e.g. crumpled cloth), only rebuild a branch
+ * when its children overlap this much more than they did at their best since the last rebuild,
+ * so such branches are not rebuilt on every update. */
+#define BVH_DEGENERATE_AREA_HYSTERESIS 0.1f
+
+typedef struct BVHUpdateData {
+  BVHTree *tree;
+  /* Branches with the same indices as used by #non_recursive_bvh_div_nodes. */
+  BVHNode *branches_array;
+  /* First branch of each level, followed by the number of branches plus one. */
+  int level_start[33];
+  int levels_num;
+
+  /* Only used for rebuilding. */
+  BVHBuildHelper build_data;
+  int rebuilt_num;
+} BVHUpdateData;
+
+static void bvhtree_update_data_init(BVHTree *tree, BVHUpdateData *data)
+{
+  const int tree_offset = 2 - tree->tree_type;
+
+  data->tree = tree;
+  data->branches_array = tree->nodearray + (tree->totleaf - 1);
+  data->levels_num = 0;
+  for (int i = 1; i <= tree->totbranch; i = i * tree->tree_type + tree_offset) {
+    data->level_start[data->levels_num++] = i;
+  }
+  data->level_start[data->levels_num] = tree->totbranch + 1;
+}
+
+static void bvhtree_update_refit_task_cb(void *__restrict userdata,
+                                         const int j,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHUpdateData *data = userdata;
+  node_join(data->tree, &data->branches_array[j]);
+}
+
+/**
+ * Summed surface area of the children relative to that many copies of the branch,
+ * in 1/255 steps: zero when the children are separate, 255 when they all match the branch.
+ */
+static unsigned char bvhtree_node_overlap(const BVHNode *node)
+{
+  const float area = bv_surface_area(node->bv);
+  if (!(area > 0.0f)) {
+    return 0;
+  }
+
+  float children_area = 0.0f;
+  for (int k = 0; k < node->totnode; k++) {
+    children_area += bv_surface_area(node->children[k]->bv);
+  }
+  return unit_float_to_uchar_clamp(children_area / (area * (float)node->totnode));
+}
+
+/**
+ * Partition the leafs of branch \a j at level \a level again,
+ * running the same steps #non_recursive_bvh_div_nodes does for the branches below it.
+ */
+static void bvhtree_rebuild_subtree(BVHUpdateData *data, const int level, const int j)
+{
+  const BVHTree *tree = data->tree;
+  const int tree_type = tree->tree_type;
+  const int tree_offset = 2 - tree_type;
+
+  BVHDivNodesData cb_data = {
+      .tree = tree,
+      .branches_array = data->branches_array,
+      .leafs_array = data->tree->nodes,
+      .tree_type = tree_type,
+      .tree_offset = tree_offset,
+      .data = &data->build_data,
+  };
+
+  int j_begin = j, j_end = j + 1;
+  for (int l = level; l < data->levels_num && j_begin <= tree->totbranch; l++) {
+    const int i = data->level_start[l];
+    cb_data.first_of_next_level = i * tree_type + tree_offset;
+    cb_data.i = i;
+    cb_data.depth = l + 1;
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (j_end - j_begin > KDOPBVH_THREAD_LEAF_THRESHOLD);
+    BLI_task_parallel_range(j_begin,
+                            min_ii(j_end, tree->totbranch + 1),
+                            &cb_data,
+                            non_recursive_bvh_div_nodes_task_cb,
+                            &settings);
+
+    /* The children of a range of branches are the next range of branches. */
+    j_begin = j_begin * tree_type + tree_offset;
+    j_end = j_end * tree_type + tree_offset;
+  }
+
+  /* Remember how well the new splits separate the leafs, now that all bounds are known. */
+  j_begin = j;
+  j_end = j + 1;
+  for (int l = level; l < data->levels_num && j_begin <= tree->totbranch; l++) {
+    for (int k = j_begin; k < min_ii(j_end, tree->totbranch + 1); k++) {
+      BVHNode *node = &data->branches_array[k];
+      node->overlap_min = bvhtree_node_overlap(node);
+    }
+    j_begin = j_begin * tree_type + tree_offset;
+    j_end = j_end * tree_type + tree_offset;
+  }
+}
+
+/**
+ * Find the top-most degenerate branches and rebuild them, the bounds of their parents
+ * don't change since the same leafs stay below them.
+ */
+static void bvhtree_rebuild_degenerate_recursive(BVHUpdateData *data, const int level, const int j)
+{
+  BVHNode *node = &data->branches_array[j];
+  const int tree_offset = 2 - data->tree->tree_type;
+
+  /* Only leafs below, there is nothing to partition. */
+  if (node->children[0]->totnode == 0) {
+    return;
+  }
+
+  const unsigned char overlap = bvhtree_node_overlap(node);
+  const float overlap_limit = max_ff(
+      BVH_DEGENERATE_AREA_FACTOR,
+      (float)node->overlap_min / 255.0f + BVH_DEGENERATE_AREA_HYSTERESIS);
+  if ((float)overlap / 255.0f > overlap_limit) {
+    bvhtree_rebuild_subtree(data, level, j);
+    data->rebuilt_num++;
+    return;
+  }
+  if (overlap < node->overlap_min) {
+    node->overlap_min = overlap;
+  }
+
+  for (int k = 0; k < node->totnode; k++) {
+    const int child_index = j * data->tree->tree_type + tree_offset + k;
+    if (child_index <= data->tree->totbranch &&
+        node->children[k] == &data->branches_array[child_index]) {
+      bvhtree_rebuild_degenerate_recursive(data, level + 1, child_index);
+    }
+  }
+}
+
 /**
  * Call #BLI_bvhtree_update_node() first for every node/point/triangle.
+ *
+ * \param flag: #BVH_UPDATE_REBUILD_DEGENERATE to partition the leafs of branches again
+ * when their children overlap too much after the update (only for k-DOPs that include
+ * the coordinate axes), this costs less than building a new tree when only parts degenerated.
+ * \return The number of branches whose leafs were partitioned again.
  */
-void BLI_bvhtree_update_tree(BVHTree *tree)
+int BLI_bvhtree_update_tree_ex(BVHTree *tree, int flag)
 {
-  /* Update bottom=>top
-   * TRICKY: the way we build the tree all the children have an index greater than the parent
-   * This allows us todo a bottom up update by starting on the bigger numbered branch. */
+  if (tree->totbranch == 0) {
+    return 0;
+  }
 
-  BVHNode **root = tree->nodes + tree->totleaf;
-  BVHNode **index = tree->nodes + tree->totleaf + tree->totbranch - 1;
+  BVHUpdateData data;
+  bvhtree_update_data_init(tree, &data);
 
-  for (; index >= root; index--) {
-    node_join(tree, *index);
+  /* Update bottom=>top, one level at a time,
+   * branches of the same level don't depend on each other. */
+  for (int level = data.levels_num - 1; level >= 0; level--) {
+    const int i = data.level_start[level];
+    const int i_stop = data.level_start[level + 1];
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (i_stop - i > KDOPBVH_THREAD_LEAF_THRESHOLD);
+    settings.min_iter_per_thread = KDOPBVH_THREAD_LEAF_THRESHOLD;
+    BLI_task_parallel_range(i, i_stop, &data, bvhtree_update_refit_task_cb, &settings);
   }
+
+  if ((flag & BVH_UPDATE_REBUILD_DEGENERATE) && (tree->start_axis == 0) && (tree->totleaf > 1)) {
+    build_implicit_tree_helper(tree, &data.build_data);
+    data.rebuilt_num = 0;
+    bvhtree_rebuild_degenerate_recursive(&data, 0, 1);
+
+#ifdef USE_SKIP_LINKS
+    if (data.rebuilt_num != 0) {
+      build_skip_links(tree, tree->nodes[tree->totleaf], NULL, NULL);
+    }
+#endif
+    return data.rebuilt_num;
+  }
+  return 0;
+}
+
+void BLI_bvhtree_update_tree(BVHTree *tree)
+{
+  BLI_bvhtree_update_tree_ex(tree, 0);
 }
 /**
  * Number of times #BLI_bvhtree_insert has been called.
@@ -2041,6 +2236,186 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree batched queries
+ *
+ * Run many queries against the same tree. Queries are sorted along a Morton curve so that
+ * consecutive queries visit the same nodes, then processed in parallel in contiguous chunks.
+ * \{ */
+
+/* Bits per axis of the Morton code. */
+#define BVH_BATCH_MORTON_BITS 9
+
+typedef struct BVHBatchOrder {
+  uint code;
+  int index;
+} BVHBatchOrder;
+
+static uint bvhtree_batch_morton_expand(uint v)
+{
+  /* Spread the lower 10 bits so there are two zero bits between each. */
+  v = (v * 0x00010001u) & 0xFF0000FFu;
+  v = (v * 0x00000101u) & 0x0F00F00Fu;
+  v = (v * 0x00000011u) & 0xC30C30C3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+static int bvhtree_batch_order_cmp(const void *a_v, const void *b_v)
+{
+  const BVHBatchOrder *a = a_v, *b = b_v;
+  if (a->code < b->code) {
+    return -1;
+  }
+  if (a->code > b->code) {
+    return 1;
+  }
+  return (a->index > b->index) - (a->index < b->index);
+}
+
+/**
+ * \return The query indices sorted so spatially close queries are adjacent.
+ */
+static int *bvhtree_batch_order_create(const float (*co)[3], const int len)
+{
+  const int grid_max = (1 << BVH_BATCH_MORTON_BITS) - 1;
+  float min[3], max[3], scale[3];
+
+  INIT_MINMAX(min, max);
+  for (int i = 0; i < len; i++) {
+    minmax_v3v3_v3(min, max, co[i]);
+  }
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = max[axis] - min[axis];
+    scale[axis] = (extent > 0.0f) ? (float)grid_max / extent : 0.0f;
+  }
+
+  BVHBatchOrder *order = MEM_malloc_arrayN((size_t)len, sizeof(*order), __func__);
+  for (int i = 0; i < len; i++) {
+    uint code = 0;
+    for (int axis = 0; axis < 3; axis++) {
+      const uint grid = (uint)clamp_i((int)((co[i][axis] - min[axis]) * scale[axis]), 0, grid_max);
+      code |= bvhtree_batch_morton_expand(grid) << axis;
+    }
+    order[i].code = code;
+    order[i].index = i;
+  }
+
+  qsort(order, (size_t)len, sizeof(*order), bvhtree_batch_order_cmp);
+
+  int *indices = MEM_malloc_arrayN((size_t)len, sizeof(*indices), __func__);
+  for (int i = 0; i < len; i++) {
+    indices[i] = order[i].index;
+  }
+  MEM_freeN(order);
+  return indices;
+}
+
+typedef struct BVHNearestBatchData {
+  BVHTree *tree;
+  const float (*co)[3];
+  BVHTreeNearest *nearest;
+  BVHTree_NearestPointCallback callback;
+  void *userdata;
+  int flag;
+  const int *order;
+} BVHNearestBatchData;
+
+typedef struct BVHNearestBatchChunk {
+  /* Result of the previous query in this chunk. */
+  int index_prev;
+  float co_prev[3];
+} BVHNearestBatchChunk;
+
+static void bvhtree_find_nearest_batch_cb(void *__restrict userdata,
+                                          const int iter,
+                                          const TaskParallelTLS *__restrict tls)
+{
+  const BVHNearestBatchData *data = userdata;
+  BVHNearestBatchChunk *chunk = tls->userdata_chunk;
+  const int i = data->order[iter];
+  BVHTreeNearest *nearest = &data->nearest[i];
+
+  /* The previous query is close by, its result bounds the search radius. */
+  if (chunk->index_prev != -1) {
+    if (data->callback) {
+      BVHTreeNearest seed = *nearest;
+      data->callback(data->userdata, chunk->index_prev, data->co[i], &seed);
+      if (seed.dist_sq < nearest->dist_sq) {
+        *nearest = seed;
+        nearest->index = chunk->index_prev;
+      }
+    }
+    else {
+      /* The previous nearest point lies on the bounds of that element. */
+      const float dist_sq = len_squared_v3v3(data->co[i], chunk->co_prev);
+      if (dist_sq < nearest->dist_sq) {
+        nearest->index = chunk->index_prev;
+        nearest->dist_sq = dist_sq;
+        copy_v3_v3(nearest->co, chunk->co_prev);
+      }
+    }
+  }
+
+  BLI_bvhtree_find_nearest_ex(
+      data->tree, data->co[i], nearest, data->callback, data->userdata, data->flag);
+
+  /* Queries which found nothing (e.g. started with a zero distance) keep the previous seed. */
+  if (nearest->index != -1) {
+    chunk->index_prev = nearest->index;
+    copy_v3_v3(chunk->co_prev, nearest->co);
+  }
+}
+
+/**
+ * Find the nearest element for each of \a co_len points.
+ *
+ * \param r_nearest: Array of \a co_len items, initialized by the caller the same way as for
+ * #BLI_bvhtree_find_nearest_ex (the initial `dist_sq` limits the search).
+ * \param callback: Must be thread-safe and only depend on its arguments,
+ * the result of a nearby query may be passed in as the initial nearest element.
+ *
+ * \note The nearest distance is always the same as for the single query. When several elements
+ * are equally near, the index may differ, since the initial nearest element is kept on ties.
+ */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int co_len,
+                                    BVHTreeNearest *r_nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag)
+{
+  if (co_len == 0) {
+    return;
+  }
+
+  int *order = bvhtree_batch_order_create(co, co_len);
+
+  BVHNearestBatchData data = {
+      .tree = tree,
+      .co = co,
+      .nearest = r_nearest,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+      .order = order,
+  };
+  BVHNearestBatchChunk chunk = {.index_prev = -1};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (co_len > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.userdata_chunk = &chunk;
+  settings.userdata_chunk_size = sizeof(chunk);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, co_len, &data, bvhtree_find_nearest_batch_cb, &settings);
+
+  MEM_freeN(order);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
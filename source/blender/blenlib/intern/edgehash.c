@@ -444,7 +444,7 @@ void BLI_edgehash_clear_ex(EdgeHash *eh, EdgeHashFreeFP free_value, const uint U
   edgehash_free_values(eh, free_value);
   eh->length = 0;
   eh->dummy_count = 0;
-  eh->capacity_exp = CAPACITY_EXP_DEFAULT;
+  /* Keep the current capacity, the arrays are allocated for it. */
   CLEAR_MAP(eh);
 }
 
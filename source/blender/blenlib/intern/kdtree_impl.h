@@ -23,6 +23,7 @@
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
 #include "BLI_strict_flags.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #define _CONCAT_AUX(MACRO_ARG1, MACRO_ARG2) MACRO_ARG1##MACRO_ARG2
@@ -56,6 +57,11 @@ struct KDTree {
 #define KD_NEAR_ALLOC_INC 100 /* alloc increment for collecting nearest */
 #define KD_FOUND_ALLOC_INC 50 /* alloc increment for collecting nearest */
 
+/* Balance ranges with more nodes than this in parallel. */
+#define KD_BALANCE_THREAD_THRESHOLD 8192
+/* Minimum number of queries each thread runs for batched searches. */
+#define KD_BATCH_QUERIES_PER_THREAD 64
+
 #define KD_NODE_UNSET ((uint)-1)
 
 /**
@@ -145,18 +151,25 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * The node #kdtree_balance places at the root of a range, known before balancing it.
+ */
+static uint kdtree_balance_root(uint nodes_len, const uint ofs)
 {
-  KDTreeNode *node;
-  float co;
-  uint left, right, median, i, j;
-
-  if (nodes_len <= 0) {
+  if (nodes_len == 0) {
     return KD_NODE_UNSET;
   }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
+  return (nodes_len / 2) + ofs;
+}
+
+/**
+ * Move the median node along \a axis to the middle of \a nodes,
+ * with smaller values before and larger values after it.
+ */
+static uint kdtree_balance_partition(KDTreeNode *nodes, uint nodes_len, uint axis)
+{
+  float co;
+  uint left, right, median, i, j;
 
   /* quicksort style sorting around median */
   left = 0;
@@ -190,9 +203,26 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  nodes[median].d = axis;
+  return median;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
   /* set node and sort subnodes */
   node = &nodes[median];
-  node->d = axis;
   axis = (axis + 1) % KD_DIMS;
   node->left = kdtree_balance(nodes, median, axis, ofs);
   node->right = kdtree_balance(
@@ -201,6 +231,47 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+typedef struct KDTreeBalanceTask {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+} KDTreeBalanceTask;
+
+static void kdtree_balance_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTask *task = taskdata;
+  KDTreeNode *nodes = task->nodes;
+  uint nodes_len = task->nodes_len;
+  uint axis = task->axis;
+  uint ofs = task->ofs;
+
+  /* Both sides of the median don't share any nodes, hand the left side
+   * to another thread and continue with the right side. */
+  while (nodes_len > KD_BALANCE_THREAD_THRESHOLD) {
+    const uint median = kdtree_balance_partition(nodes, nodes_len, axis);
+    const uint right_len = nodes_len - (median + 1);
+    KDTreeNode *node = &nodes[median];
+
+    axis = (axis + 1) % KD_DIMS;
+    node->left = kdtree_balance_root(median, ofs);
+    node->right = kdtree_balance_root(right_len, (median + 1) + ofs);
+
+    KDTreeBalanceTask *task_left = MEM_mallocN(sizeof(*task_left), __func__);
+    task_left->nodes = nodes;
+    task_left->nodes_len = median;
+    task_left->axis = axis;
+    task_left->ofs = ofs;
+    BLI_task_pool_push(pool, kdtree_balance_task_run, task_left, true, NULL);
+
+    nodes += median + 1;
+    nodes_len = right_len;
+    ofs += median + 1;
+  }
+
+  kdtree_balance(nodes, nodes_len, axis, ofs);
+}
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -210,7 +281,22 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len > KD_BALANCE_THREAD_THRESHOLD) {
+    TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+    KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+    task->nodes = tree->nodes;
+    task->nodes_len = tree->nodes_len;
+    task->axis = 0;
+    task->ofs = 0;
+    BLI_task_pool_push(pool, kdtree_balance_task_run, task, true, NULL);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+
+    tree->root = kdtree_balance_root(tree->nodes_len, 0);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -230,6 +316,23 @@ static uint *realloc_nodes(uint *stack, uint *stack_len_capacity, const bool is_
   return stack_new;
 }
 
+/**
+ * Traversal stack that can be kept between searches,
+ * so batched searches only allocate it once per thread.
+ */
+typedef struct KDTreeStack {
+  uint *data;
+  uint len_capacity;
+  bool is_alloc;
+} KDTreeStack;
+
+static uint *kdtree_stack_grow(KDTreeStack *stack, uint *data, uint *len_capacity)
+{
+  data = realloc_nodes(data, len_capacity, stack->is_alloc);
+  stack->is_alloc = true;
+  return data;
+}
+
 /**
  * Find nearest returns index, and -1 if no node is found.
  */
@@ -472,24 +575,19 @@ static void nearest_ordered_insert(KDTreeNearest *nearest,
   copy_vn_vn(nearest[i].co, co);
 }
 
-/**
- * Find \a nearest_len_capacity nearest returns number of points found, with results in nearest.
- *
- * \param r_nearest: An array of nearest, sized at least \a nearest_len_capacity.
- */
-int BLI_kdtree_nd_(find_nearest_n_with_len_squared_cb)(
-    const KDTree *tree,
-    const float co[KD_DIMS],
-    KDTreeNearest r_nearest[],
-    const uint nearest_len_capacity,
-    float (*len_sq_fn)(const float co_search[KD_DIMS],
-                       const float co_test[KD_DIMS],
-                       const void *user_data),
-    const void *user_data)
+static int kdtree_find_nearest_n(const KDTree *tree,
+                                 const float co[KD_DIMS],
+                                 KDTreeNearest r_nearest[],
+                                 const uint nearest_len_capacity,
+                                 float (*len_sq_fn)(const float co_search[KD_DIMS],
+                                                    const float co_test[KD_DIMS],
+                                                    const void *user_data),
+                                 const void *user_data,
+                                 KDTreeStack *r_stack)
 {
   const KDTreeNode *nodes = tree->nodes;
   const KDTreeNode *root;
-  uint *stack, stack_default[KD_STACK_INIT];
+  uint *stack;
   float cur_dist;
   uint stack_len_capacity, cur = 0;
   uint i, nearest_len = 0;
@@ -507,8 +605,8 @@ int BLI_kdtree_nd_(find_nearest_n_with_len_squared_cb)(
     BLI_assert(user_data == NULL);
   }
 
-  stack = stack_default;
-  stack_len_capacity = ARRAY_SIZE(stack_default);
+  stack = r_stack->data;
+  stack_len_capacity = r_stack->len_capacity;
 
   root = &nodes[tree->root];
 
@@ -576,7 +674,7 @@ int BLI_kdtree_nd_(find_nearest_n_with_len_squared_cb)(
       }
     }
     if (UNLIKELY(cur + KD_DIMS > stack_len_capacity)) {
-      stack = realloc_nodes(stack, &stack_len_capacity, stack_default != stack);
+      stack = kdtree_stack_grow(r_stack, stack, &stack_len_capacity);
     }
   }
 
@@ -584,13 +682,39 @@ int BLI_kdtree_nd_(find_nearest_n_with_len_squared_cb)(
     r_nearest[i].dist = sqrtf(r_nearest[i].dist);
   }
 
-  if (stack != stack_default) {
-    MEM_freeN(stack);
-  }
+  r_stack->data = stack;
+  r_stack->len_capacity = stack_len_capacity;
 
   return (int)nearest_len;
 }
 
+/**
+ * Find \a nearest_len_capacity nearest returns number of points found, with results in nearest.
+ *
+ * \param r_nearest: An array of nearest, sized at least \a nearest_len_capacity.
+ */
+int BLI_kdtree_nd_(find_nearest_n_with_len_squared_cb)(
+    const KDTree *tree,
+    const float co[KD_DIMS],
+    KDTreeNearest r_nearest[],
+    const uint nearest_len_capacity,
+    float (*len_sq_fn)(const float co_search[KD_DIMS],
+                       const float co_test[KD_DIMS],
+                       const void *user_data),
+    const void *user_data)
+{
+  uint stack_default[KD_STACK_INIT];
+  KDTreeStack stack = {stack_default, ARRAY_SIZE(stack_default), false};
+
+  const int nearest_len = kdtree_find_nearest_n(
+      tree, co, r_nearest, nearest_len_capacity, len_sq_fn, user_data, &stack);
+
+  if (stack.is_alloc) {
+    MEM_freeN(stack.data);
+  }
+  return nearest_len;
+}
+
 int BLI_kdtree_nd_(find_nearest_n)(const KDTree *tree,
                                    const float co[KD_DIMS],
                                    KDTreeNearest r_nearest[],
@@ -731,25 +855,17 @@ int BLI_kdtree_nd_(range_search)(const KDTree *tree,
   return BLI_kdtree_nd_(range_search_with_len_squared_cb)(tree, co, r_nearest, range, NULL, NULL);
 }
 
-/**
- * A version of #BLI_kdtree_3d_range_search which runs a callback
- * instead of allocating an array.
- *
- * \param search_cb: Called for every node found in \a range,
- * false return value performs an early exit.
- *
- * \note the order of calls isn't sorted based on distance.
- */
-void BLI_kdtree_nd_(range_search_cb)(
+static void kdtree_range_search_cb(
     const KDTree *tree,
     const float co[KD_DIMS],
     float range,
     bool (*search_cb)(void *user_data, int index, const float co[KD_DIMS], float dist_sq),
-    void *user_data)
+    void *user_data,
+    KDTreeStack *r_stack)
 {
   const KDTreeNode *nodes = tree->nodes;
 
-  uint *stack, stack_default[KD_STACK_INIT];
+  uint *stack;
   float range_sq = range * range, dist_sq;
   uint stack_len_capacity, cur = 0;
 
@@ -761,8 +877,8 @@ void BLI_kdtree_nd_(range_search_cb)(
     return;
   }
 
-  stack = stack_default;
-  stack_len_capacity = ARRAY_SIZE(stack_default);
+  stack = r_stack->data;
+  stack_len_capacity = r_stack->len_capacity;
 
   stack[cur++] = tree->root;
 
@@ -796,16 +912,194 @@ void BLI_kdtree_nd_(range_search_cb)(
     }
 
     if (UNLIKELY(cur + KD_DIMS > stack_len_capacity)) {
-      stack = realloc_nodes(stack, &stack_len_capacity, stack_default != stack);
+      stack = kdtree_stack_grow(r_stack, stack, &stack_len_capacity);
     }
   }
 
 finally:
-  if (stack != stack_default) {
-    MEM_freeN(stack);
+  r_stack->data = stack;
+  r_stack->len_capacity = stack_len_capacity;
+}
+
+/**
+ * A version of #BLI_kdtree_3d_range_search which runs a callback
+ * instead of allocating an array.
+ *
+ * \param search_cb: Called for every node found in \a range,
+ * false return value performs an early exit.
+ *
+ * \note the order of calls isn't sorted based on distance.
+ */
+void BLI_kdtree_nd_(range_search_cb)(
+    const KDTree *tree,
+    const float co[KD_DIMS],
+    float range,
+    bool (*search_cb)(void *user_data, int index, const float co[KD_DIMS], float dist_sq),
+    void *user_data)
+{
+  uint stack_default[KD_STACK_INIT];
+  KDTreeStack stack = {stack_default, ARRAY_SIZE(stack_default), false};
+
+  kdtree_range_search_cb(tree, co, range, search_cb, user_data, &stack);
+
+  if (stack.is_alloc) {
+    MEM_freeN(stack.data);
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Searches
+ *
+ * Run a search for many coordinates in parallel,
+ * each thread allocates a single traversal stack for all its searches.
+ * \{ */
+
+static void kdtree_batch_stack_ensure(KDTreeStack *stack)
+{
+  if (stack->data == NULL) {
+    stack->len_capacity = KD_STACK_INIT;
+    stack->data = MEM_mallocN(sizeof(uint) * stack->len_capacity, __func__);
+    stack->is_alloc = true;
+  }
+}
+
+static void kdtree_batch_stack_free(const void *__restrict UNUSED(userdata),
+                                    void *__restrict chunk)
+{
+  KDTreeStack *stack = chunk;
+  if (stack->data) {
+    MEM_freeN(stack->data);
+  }
+}
+
+static void kdtree_batch_settings_init(TaskParallelSettings *settings,
+                                       const uint co_len,
+                                       KDTreeStack *stack)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (co_len > KD_BATCH_QUERIES_PER_THREAD);
+  settings->min_iter_per_thread = KD_BATCH_QUERIES_PER_THREAD;
+  settings->userdata_chunk = stack;
+  settings->userdata_chunk_size = sizeof(*stack);
+  settings->func_free = kdtree_batch_stack_free;
+}
+
+typedef struct KDTreeFindNearestNBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  KDTreeNearest *nearest;
+  int *nearest_len;
+  uint nearest_len_capacity;
+} KDTreeFindNearestNBatchData;
+
+static void kdtree_find_nearest_n_batch_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict tls)
+{
+  const KDTreeFindNearestNBatchData *data = userdata;
+  KDTreeStack *stack = tls->userdata_chunk;
+  kdtree_batch_stack_ensure(stack);
+
+  KDTreeNearest *nearest = &data->nearest[(uint)i * data->nearest_len_capacity];
+  data->nearest_len[i] = kdtree_find_nearest_n(
+      data->tree, data->co[i], nearest, data->nearest_len_capacity, NULL, NULL, stack);
+}
+
+/**
+ * #BLI_kdtree_3d_find_nearest_n for each of \a co_len coordinates.
+ *
+ * \param r_nearest: Array of `co_len * nearest_len_capacity` items,
+ * the results of \a co[i] start at `i * nearest_len_capacity`.
+ * \param r_nearest_len: Array of \a co_len items, the number of points found for each coordinate.
+ */
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          const float (*co)[KD_DIMS],
+                                          const uint co_len,
+                                          KDTreeNearest *r_nearest,
+                                          int *r_nearest_len,
+                                          const uint nearest_len_capacity)
+{
+  KDTreeFindNearestNBatchData data = {
+      .tree = tree,
+      .co = co,
+      .nearest = r_nearest,
+      .nearest_len = r_nearest_len,
+      .nearest_len_capacity = nearest_len_capacity,
+  };
+  KDTreeStack stack = {NULL, 0, false};
+
+  TaskParallelSettings settings;
+  kdtree_batch_settings_init(&settings, co_len, &stack);
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_find_nearest_n_batch_cb, &settings);
+}
+
+typedef struct KDTreeRangeSearchBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  float range;
+  bool (*search_cb)(
+      void *user_data, int co_index, int index, const float co[KD_DIMS], float dist_sq);
+  void *user_data;
+} KDTreeRangeSearchBatchData;
+
+typedef struct KDTreeRangeSearchBatchQuery {
+  const KDTreeRangeSearchBatchData *data;
+  int co_index;
+} KDTreeRangeSearchBatchQuery;
+
+static bool kdtree_range_search_batch_query_cb(void *user_data,
+                                               int index,
+                                               const float co[KD_DIMS],
+                                               float dist_sq)
+{
+  const KDTreeRangeSearchBatchQuery *query = user_data;
+  return query->data->search_cb(query->data->user_data, query->co_index, index, co, dist_sq);
+}
+
+static void kdtree_range_search_batch_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict tls)
+{
+  const KDTreeRangeSearchBatchData *data = userdata;
+  KDTreeStack *stack = tls->userdata_chunk;
+  kdtree_batch_stack_ensure(stack);
+
+  KDTreeRangeSearchBatchQuery query = {data, i};
+  kdtree_range_search_cb(
+      data->tree, data->co[i], data->range, kdtree_range_search_batch_query_cb, &query, stack);
+}
+
+/**
+ * #BLI_kdtree_3d_range_search_cb for each of \a co_len coordinates.
+ *
+ * \param search_cb: Called from multiple threads with the index of the searched coordinate,
+ * false return value stops the search for that coordinate.
+ */
+void BLI_kdtree_nd_(range_search_cb_batch)(
+    const KDTree *tree,
+    const float (*co)[KD_DIMS],
+    const uint co_len,
+    float range,
+    bool (*search_cb)(
+        void *user_data, int co_index, int index, const float co[KD_DIMS], float dist_sq),
+    void *user_data)
+{
+  KDTreeRangeSearchBatchData data = {
+      .tree = tree,
+      .co = co,
+      .range = range,
+      .search_cb = search_cb,
+      .user_data = user_data,
+  };
+  KDTreeStack stack = {NULL, 0, false};
+
+  TaskParallelSettings settings;
+  kdtree_batch_settings_init(&settings, co_len, &stack);
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_range_search_batch_cb, &settings);
+}
+
+/** \} */
+
 /**
  * Use when we want to loop over nodes ordered by index.
  * Requires indices to be aligned with nodes.
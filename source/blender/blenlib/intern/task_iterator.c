@@ -102,8 +102,10 @@ typedef struct TaskParallelIteratorState {
 static void parallel_iterator_func_do(TaskParallelIteratorState *__restrict state,
                                       void *userdata_chunk)
 {
+  TaskParallelScratch scratch = {NULL};
   TaskParallelTLS tls = {
       .userdata_chunk = userdata_chunk,
+      .scratch = &scratch,
   };
 
   void **current_chunk_items;
@@ -148,9 +150,12 @@ static void parallel_iterator_func_do(TaskParallelIteratorState *__restrict stat
 
     for (i = 0; i < current_chunk_size; ++i) {
       state->func(state->userdata, current_chunk_items[i], current_chunk_indices[i], &tls);
+      BLI_task_parallel_scratch_iter_end(&scratch);
     }
   }
 
+  BLI_task_parallel_scratch_free(&scratch);
+
   MALLOCA_FREE(current_chunk_items, items_size);
   MALLOCA_FREE(current_chunk_indices, indices_size);
 }
@@ -39,6 +39,8 @@
 #  include <tbb/tbb.h>
 #endif
 
+#include "task_intern.hh"
+
 /* Task
  *
  * Unit of work to execute. This is a C++ class to work with TBB. */
@@ -124,13 +126,15 @@ class Task {
 
 /* TBB Task Group.
  *
- * Subclass since there seems to be no other way to set priority. */
+ * Subclass since there seems to be no other way to set priority. Newer TBB versions
+ * don't support this, there the low priority arena of the task pool is all that is left. */
 
 #ifdef WITH_TBB
 class TBBTaskGroup : public tbb::task_group {
  public:
   TBBTaskGroup(TaskPriority priority)
   {
+#  if TBB_INTERFACE_VERSION_MAJOR < 12
     switch (priority) {
       case TASK_PRIORITY_LOW:
         my_context.set_priority(tbb::priority_low);
@@ -139,6 +143,9 @@ class TBBTaskGroup : public tbb::task_group {
         my_context.set_priority(tbb::priority_normal);
         break;
     }
+#  else
+    UNUSED_VARS(priority);
+#  endif
   }
 
   ~TBBTaskGroup()
@@ -167,6 +174,8 @@ struct TaskPool {
   /* TBB task pool. */
 #ifdef WITH_TBB
   TBBTaskGroup tbb_group;
+  /* Arena to run and wait for tasks in, null to use the arena of the calling thread. */
+  tbb::task_arena *tbb_arena;
 #endif
   volatile bool is_suspended;
   BLI_mempool *suspended_mempool;
@@ -185,7 +194,7 @@ struct TaskPool {
  * Tasks may be suspended until in all are created, to make it possible to
  * initialize data structures and create tasks in a single pass. */
 
-static void tbb_task_pool_create(TaskPool *pool, TaskPriority priority)
+static void tbb_task_pool_create(TaskPool *pool, TaskPriority priority, const bool is_background)
 {
   if (pool->type == TASK_POOL_TBB_SUSPENDED) {
     pool->is_suspended = true;
@@ -195,9 +204,14 @@ static void tbb_task_pool_create(TaskPool *pool, TaskPriority priority)
 #ifdef WITH_TBB
   if (pool->use_threads) {
     new (&pool->tbb_group) TBBTaskGroup(priority);
+    /* Pools that are waited on right away keep the threads of the caller's arena,
+     * only background jobs are limited so they can't take all threads. */
+    pool->tbb_arena = (is_background && priority == TASK_PRIORITY_LOW) ?
+                          task_scheduler_tbb_background_arena_get() :
+                          nullptr;
   }
 #else
-  UNUSED_VARS(priority);
+  UNUSED_VARS(priority, is_background);
 #endif
 }
 
@@ -218,7 +232,12 @@ static void tbb_task_pool_run(TaskPool *pool, Task &&task)
 #ifdef WITH_TBB
   else if (pool->use_threads) {
     /* Execute in TBB task group. */
-    pool->tbb_group.run(std::move(task));
+    if (pool->tbb_arena) {
+      pool->tbb_arena->execute([&]() { pool->tbb_group.run(std::move(task)); });
+    }
+    else {
+      pool->tbb_group.run(std::move(task));
+    }
   }
 #endif
   else {
@@ -247,7 +266,12 @@ static void tbb_task_pool_work_and_wait(TaskPool *pool)
     /* This is called wait(), but internally it can actually do work. This
      * matters because we don't want recursive usage of task pools to run
      * out of threads and get stuck. */
-    pool->tbb_group.wait();
+    if (pool->tbb_arena) {
+      pool->tbb_arena->execute([&]() { pool->tbb_group.wait(); });
+    }
+    else {
+      pool->tbb_group.wait();
+    }
   }
 #endif
 }
@@ -257,7 +281,12 @@ static void tbb_task_pool_cancel(TaskPool *pool)
 #ifdef WITH_TBB
   if (pool->use_threads) {
     pool->tbb_group.cancel();
-    pool->tbb_group.wait();
+    if (pool->tbb_arena) {
+      pool->tbb_arena->execute([&]() { pool->tbb_group.wait(); });
+    }
+    else {
+      pool->tbb_group.wait();
+    }
   }
 #else
   UNUSED_VARS(pool);
@@ -268,7 +297,12 @@ static bool tbb_task_pool_canceled(TaskPool *pool)
 {
 #ifdef WITH_TBB
   if (pool->use_threads) {
+#  if TBB_INTERFACE_VERSION_MAJOR < 12
     return pool->tbb_group.is_canceling();
+#  else
+    /* Only called from tasks of the pool itself. */
+    return tbb::is_current_task_group_canceling();
+#  endif
   }
 #else
   UNUSED_VARS(pool);
@@ -369,6 +403,7 @@ static TaskPool *task_pool_create_ex(void *userdata, TaskPoolType type, TaskPrio
   /* Background task pool uses regular TBB scheduling if available. Only when
    * building without TBB or running with -t 1 do we need to ensure these tasks
    * do not block the main thread. */
+  const bool is_background = (type == TASK_POOL_BACKGROUND);
   if (type == TASK_POOL_BACKGROUND && use_threads) {
     type = TASK_POOL_TBB;
   }
@@ -386,7 +421,7 @@ static TaskPool *task_pool_create_ex(void *userdata, TaskPoolType type, TaskPrio
     case TASK_POOL_TBB:
     case TASK_POOL_TBB_SUSPENDED:
     case TASK_POOL_NO_THREADS:
-      tbb_task_pool_create(pool, priority);
+      tbb_task_pool_create(pool, priority, is_background);
       break;
     case TASK_POOL_BACKGROUND:
     case TASK_POOL_BACKGROUND_SERIAL:
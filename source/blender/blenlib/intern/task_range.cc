@@ -26,6 +26,7 @@
 
 #include "DNA_listBase.h"
 
+#include "BLI_memarena.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
@@ -37,8 +38,67 @@
 #  include <tbb/tbb.h>
 #endif
 
+/* -------------------------------------------------------------------- */
+/** \name Scratch Memory
+ * \{ */
+
+/* Large enough for the temporary arrays of typical callbacks to fit in a single buffer. */
+#define TASK_SCRATCH_BUFSIZE (1 << 16)
+
+static uint64_t task_scratch_allocations_total = 0;
+static uint64_t task_scratch_arenas_total = 0;
+
+void *BLI_task_parallel_scratch_alloc(const TaskParallelTLS *__restrict tls, size_t size)
+{
+  TaskParallelScratch *scratch = tls->scratch;
+  BLI_assert(scratch != NULL);
+
+  if (UNLIKELY(scratch->arena == NULL)) {
+    scratch->arena = BLI_memarena_new(TASK_SCRATCH_BUFSIZE, __func__);
+  }
+  scratch->allocations_num++;
+  return BLI_memarena_alloc(scratch->arena, size);
+}
+
+void *BLI_task_parallel_scratch_calloc(const TaskParallelTLS *__restrict tls, size_t size)
+{
+  void *ptr = BLI_task_parallel_scratch_alloc(tls, size);
+  memset(ptr, 0, size);
+  return ptr;
+}
+
+void BLI_task_parallel_scratch_stats_get(uint64_t *r_allocations_num, uint64_t *r_arenas_num)
+{
+  *r_allocations_num = atomic_add_and_fetch_uint64(&task_scratch_allocations_total, 0);
+  *r_arenas_num = atomic_add_and_fetch_uint64(&task_scratch_arenas_total, 0);
+}
+
+void BLI_task_parallel_scratch_iter_end(TaskParallelScratch *scratch)
+{
+  if (scratch->allocations_num != 0) {
+    atomic_add_and_fetch_uint64(&task_scratch_allocations_total, scratch->allocations_num);
+    scratch->allocations_num = 0;
+    BLI_memarena_clear(scratch->arena);
+  }
+}
+
+void BLI_task_parallel_scratch_free(TaskParallelScratch *scratch)
+{
+  BLI_task_parallel_scratch_iter_end(scratch);
+  if (scratch->arena != NULL) {
+    atomic_add_and_fetch_uint64(&task_scratch_arenas_total, 1);
+    BLI_memarena_free(scratch->arena);
+    scratch->arena = NULL;
+  }
+}
+
+/** \} */
+
 #ifdef WITH_TBB
 
+/* Scratch memory of every worker thread taking part in a single parallel range. */
+using RangeTaskScratch = tbb::enumerable_thread_specific<TaskParallelScratch>;
+
 /* Functor for running TBB parallel_for and parallel_reduce. */
 struct RangeTask {
   TaskParallelRangeFunc func;
@@ -47,23 +107,35 @@ struct RangeTask {
 
   void *userdata_chunk;
 
+  /* Shared by all copies, TBB makes many more copies of the task than there are threads. */
+  RangeTaskScratch *scratch;
+
   /* Root constructor. */
-  RangeTask(TaskParallelRangeFunc func, void *userdata, const TaskParallelSettings *settings)
-      : func(func), userdata(userdata), settings(settings)
+  RangeTask(TaskParallelRangeFunc func,
+            void *userdata,
+            const TaskParallelSettings *settings,
+            RangeTaskScratch *scratch)
+      : func(func), userdata(userdata), settings(settings), scratch(scratch)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Copy constructor. */
   RangeTask(const RangeTask &other)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        scratch(other.scratch)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Splitting constructor for parallel reduce. */
   RangeTask(RangeTask &other, tbb::split /* unused */)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        scratch(other.scratch)
   {
     init_chunk(settings->userdata_chunk);
   }
@@ -90,10 +162,15 @@ struct RangeTask {
   void operator()(const tbb::blocked_range<int> &r) const
   {
     tbb::this_task_arena::isolate([this, r] {
+      /* Isolation keeps this thread from running other blocks of the same range while the
+       * callbacks wait for nested tasks, so the arena is only used by one callback at a time. */
+      TaskParallelScratch &thread_scratch = scratch->local();
       TaskParallelTLS tls;
       tls.userdata_chunk = userdata_chunk;
+      tls.scratch = &thread_scratch;
       for (int i = r.begin(); i != r.end(); ++i) {
         func(userdata, i, &tls);
+        BLI_task_parallel_scratch_iter_end(&thread_scratch);
       }
     });
   }
@@ -115,7 +192,8 @@ void BLI_task_parallel_range(const int start,
 #ifdef WITH_TBB
   /* Multithreading. */
   if (settings->use_threading && BLI_task_scheduler_num_threads() > 1) {
-    RangeTask task(func, userdata, settings);
+    RangeTaskScratch scratch(TaskParallelScratch{NULL, 0});
+    RangeTask task(func, userdata, settings, &scratch);
     const size_t grainsize = MAX2(settings->min_iter_per_thread, 1);
     const tbb::blocked_range<int> range(start, stop, grainsize);
 
@@ -128,17 +206,25 @@ void BLI_task_parallel_range(const int start,
     else {
       parallel_for(range, task);
     }
+
+    for (TaskParallelScratch &thread_scratch : scratch) {
+      BLI_task_parallel_scratch_free(&thread_scratch);
+    }
     return;
   }
 #endif
 
   /* Single threaded. Nothing to reduce as everything is accumulated into the
    * main userdata chunk directly. */
+  TaskParallelScratch scratch = {NULL, 0};
   TaskParallelTLS tls;
   tls.userdata_chunk = settings->userdata_chunk;
+  tls.scratch = &scratch;
   for (int i = start; i < stop; i++) {
     func(userdata, i, &tls);
+    BLI_task_parallel_scratch_iter_end(&scratch);
   }
+  BLI_task_parallel_scratch_free(&scratch);
   if (settings->func_free != NULL) {
     settings->func_free(userdata, settings->userdata_chunk);
   }
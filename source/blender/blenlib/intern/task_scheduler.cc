@@ -20,8 +20,11 @@
  * Task scheduler initialization.
  */
 
+#include <atomic>
+
 #include "MEM_guardedalloc.h"
 
+#include "BLI_math_base.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
@@ -34,6 +37,8 @@
 #  endif
 #endif
 
+#include "task_intern.hh"
+
 /* Task Scheduler */
 
 static int task_scheduler_num_threads = 1;
@@ -41,6 +46,40 @@ static int task_scheduler_num_threads = 1;
 static tbb::global_control *task_scheduler_global_control = nullptr;
 #endif
 
+#ifdef WITH_TBB
+/* Low priority background task pools run in their own arena that has one thread less than
+ * there are, so background jobs can't take all threads away from interactive work. */
+static tbb::task_arena *task_scheduler_background_arena = nullptr;
+
+/* Put each worker thread on a NUMA node once, when it first joins the scheduler. */
+class TaskSchedulerNUMAObserver : public tbb::task_scheduler_observer {
+  std::atomic<int> num_workers_{0};
+
+ public:
+  TaskSchedulerNUMAObserver()
+  {
+    observe(true);
+  }
+
+  ~TaskSchedulerNUMAObserver()
+  {
+    observe(false);
+  }
+
+  void on_scheduler_entry(bool is_worker) override
+  {
+    static thread_local bool is_placed = false;
+    if (is_worker && !is_placed) {
+      /* The main thread takes the first processor. */
+      BLI_thread_put_thread_on_node_for_index(++num_workers_);
+      is_placed = true;
+    }
+  }
+};
+
+static TaskSchedulerNUMAObserver *task_scheduler_numa_observer = nullptr;
+#endif
+
 void BLI_task_scheduler_init()
 {
 #ifdef WITH_TBB_GLOBAL_CONTROL
@@ -63,15 +102,46 @@ void BLI_task_scheduler_init()
 #else
   task_scheduler_num_threads = BLI_system_thread_count();
 #endif
+
+#ifdef WITH_TBB
+  /* No threads are reserved for the thread that waits on a pool, background pools rely on
+   * their tasks running without anyone waiting. */
+  const int background_num_threads = max_ii(1, task_scheduler_num_threads - 1);
+#  if TBB_INTERFACE_VERSION_MAJOR >= 12
+  task_scheduler_background_arena = OBJECT_GUARDED_NEW(
+      tbb::task_arena, background_num_threads, 0, tbb::task_arena::priority::low);
+#  else
+  task_scheduler_background_arena = OBJECT_GUARDED_NEW(
+      tbb::task_arena, background_num_threads, 0);
+#  endif
+
+  if (BLI_system_numa_placement_get()) {
+    task_scheduler_numa_observer = OBJECT_GUARDED_NEW(TaskSchedulerNUMAObserver);
+  }
+#endif
 }
 
 void BLI_task_scheduler_exit()
 {
+#ifdef WITH_TBB
+  OBJECT_GUARDED_SAFE_DELETE(task_scheduler_numa_observer, TaskSchedulerNUMAObserver);
+  OBJECT_GUARDED_SAFE_DELETE(task_scheduler_background_arena, tbb::task_arena);
+#endif
 #ifdef WITH_TBB_GLOBAL_CONTROL
   OBJECT_GUARDED_DELETE(task_scheduler_global_control, tbb::global_control);
 #endif
 }
 
+#ifdef WITH_TBB
+/**
+ * Arena to run low priority background task pools in.
+ */
+tbb::task_arena *task_scheduler_tbb_background_arena_get()
+{
+  return task_scheduler_background_arena;
+}
+#endif
+
 int BLI_task_scheduler_num_threads()
 {
   return task_scheduler_num_threads;
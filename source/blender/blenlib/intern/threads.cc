@@ -121,6 +121,7 @@ static pthread_mutex_t _fftw_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t _view3d_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_t mainid;
 static bool is_numa_available = false;
+static bool use_numa_placement = false;
 static unsigned int thread_levels = 0; /* threads can be invoked inside threads */
 static int num_threads_override = 0;
 
@@ -924,3 +925,53 @@ void BLI_thread_put_thread_on_fast_node(void)
   }
 #endif
 }
+
+/**
+ * Instead of worker threads inheriting the NUMA node of the thread that started them,
+ * put each one on a node of its own (see the comment in #BLI_thread_put_process_on_fast_node).
+ * Must be set before #BLI_task_scheduler_init.
+ */
+void BLI_system_numa_placement_set(bool use_placement)
+{
+  use_numa_placement = use_placement;
+}
+
+bool BLI_system_numa_placement_get(void)
+{
+  return use_numa_placement && is_numa_available;
+}
+
+/**
+ * Put the thread on a NUMA node so that consecutive thread indices fill the processors of
+ * one node before moving on to the next.
+ */
+void BLI_thread_put_thread_on_node_for_index(int thread_index)
+{
+  if (!is_numa_available) {
+    return;
+  }
+
+  const int num_nodes = numaAPI_GetNumNodes();
+  int num_processors = 0;
+  for (int node = 0; node < num_nodes; node++) {
+    if (numaAPI_IsNodeAvailable(node)) {
+      num_processors += numaAPI_GetNumNodeProcessors(node);
+    }
+  }
+  if (num_processors == 0) {
+    return;
+  }
+
+  int processor = thread_index % num_processors;
+  for (int node = 0; node < num_nodes; node++) {
+    if (!numaAPI_IsNodeAvailable(node)) {
+      continue;
+    }
+    const int num_node_processors = numaAPI_GetNumNodeProcessors(node);
+    if (processor < num_node_processors) {
+      numaAPI_RunThreadOnNode(node);
+      return;
+    }
+    processor -= num_node_processors;
+  }
+}
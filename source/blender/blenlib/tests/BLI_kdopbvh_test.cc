@@ -8,6 +8,7 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_kdopbvh.h"
+#include "BLI_math_base.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.h"
 
@@ -132,3 +133,173 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+static void nearest_point_callback(void *userdata,
+                                   int index,
+                                   const float co[3],
+                                   BVHTreeNearest *nearest)
+{
+  float(*points)[3] = (float(*)[3])userdata;
+  const float dist_sq = len_squared_v3v3(co, points[index]);
+  if (dist_sq < nearest->dist_sq) {
+    nearest->index = index;
+    nearest->dist_sq = dist_sq;
+    copy_v3_v3(nearest->co, points[index]);
+  }
+}
+
+static void rng_v3(float *coords, int coords_len, struct RNG *rng, float scale)
+{
+  for (int i = 0; i < coords_len; i++) {
+    coords[i] = (BLI_rng_get_float(rng) * 2.0f - 1.0f) * scale;
+  }
+}
+
+/**
+ * Batched queries must find the same nearest element as querying each point on its own.
+ * The positions are not rounded, so there are no equally near elements which could make the
+ * found index differ.
+ */
+static void find_nearest_batch_test(int points_len,
+                                    int queries_len,
+                                    int random_seed,
+                                    bool use_callback)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+  BVHTree_NearestPointCallback callback = use_callback ? nearest_point_callback : NULL;
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*queries)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * queries_len,
+                                                          __func__);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3(points[i], 3, rng, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3(queries[i], 3, rng, 1.5f);
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+
+  BLI_bvhtree_find_nearest_batch(tree, queries, queries_len, nearest, callback, points, 0);
+
+  for (int i = 0; i < queries_len; i++) {
+    BVHTreeNearest nearest_single;
+    nearest_single.index = -1;
+    nearest_single.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, queries[i], &nearest_single, callback, points);
+
+    EXPECT_EQ(nearest[i].index, nearest_single.index);
+    EXPECT_EQ(nearest[i].dist_sq, nearest_single.dist_sq);
+    EXPECT_V3_NEAR(nearest[i].co, nearest_single.co, 1e-5f);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(queries);
+  MEM_freeN(nearest);
+}
+
+TEST(kdopbvh, FindNearestBatch_1)
+{
+  find_nearest_batch_test(1, 10, 1234, true);
+}
+TEST(kdopbvh, FindNearestBatch_500)
+{
+  find_nearest_batch_test(500, 5000, 12, true);
+}
+TEST(kdopbvh, FindNearestBatchNoCallback_500)
+{
+  find_nearest_batch_test(500, 5000, 12, false);
+}
+
+/**
+ * Move all points after building, then check the updated tree still finds each point.
+ * \return The number of rebuilt branches.
+ */
+static int update_tree_test(int points_len, int random_seed, int update_flag)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 6);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  /* Scramble the positions so the original partitioning no longer fits. */
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_update_node(tree, i, points[i], NULL, 1);
+  }
+  const int rebuilt_num = BLI_bvhtree_update_tree_ex(tree, update_flag);
+
+  for (int i = 0; i < points_len; i++) {
+    BVHTreeNearest nearest;
+    nearest.index = -1;
+    nearest.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, points[i], &nearest, nearest_point_callback, points);
+    EXPECT_EQ(nearest.dist_sq, 0.0f);
+  }
+
+  /* Nothing moved since the rebuild. */
+  EXPECT_EQ(BLI_bvhtree_update_tree_ex(tree, update_flag), 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  return rebuilt_num;
+}
+
+TEST(kdopbvh, UpdateTree_500)
+{
+  EXPECT_EQ(update_tree_test(500, 12, 0), 0);
+}
+TEST(kdopbvh, UpdateTreeRebuild_1)
+{
+  EXPECT_EQ(update_tree_test(1, 1234, BVH_UPDATE_REBUILD_DEGENERATE), 0);
+}
+TEST(kdopbvh, UpdateTreeRebuild_500)
+{
+  EXPECT_GT(update_tree_test(500, 12, BVH_UPDATE_REBUILD_DEGENERATE), 0);
+}
+
+/**
+ * Leafs which each cover most of the bounds overlap no matter how they are split,
+ * rebuilding them once is enough.
+ */
+TEST(kdopbvh, UpdateTreeRebuildOverlapping_500)
+{
+  const int points_len = 500;
+  struct RNG *rng = BLI_rng_new(12);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 6);
+
+  float co[2][3];
+  for (int i = 0; i < points_len; i++) {
+    rng_v3(co[0], 3, rng, 0.1f);
+    BLI_bvhtree_insert(tree, i, co[0], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3(co[0], 3, rng, 0.1f);
+    rng_v3(co[1], 3, rng, 0.1f);
+    add_v3_fl(co[0], -1.0f);
+    add_v3_fl(co[1], 1.0f);
+    BLI_bvhtree_update_node(tree, i, co[0], NULL, 2);
+  }
+  EXPECT_GT(BLI_bvhtree_update_tree_ex(tree, BVH_UPDATE_REBUILD_DEGENERATE), 0);
+  EXPECT_EQ(BLI_bvhtree_update_tree_ex(tree, BVH_UPDATE_REBUILD_DEGENERATE), 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
@@ -0,0 +1,141 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+static float (*points_random_create(int points_len, int random_seed))[3]
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i]);
+    mul_v3_fl(points[i], BLI_rng_get_float(rng));
+  }
+  BLI_rng_free(rng);
+  return points;
+}
+
+static KDTree_3d *kdtree_create(const float (*points)[3], int points_len)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(points_len);
+  for (int i = 0; i < points_len; i++) {
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+/**
+ * Large enough to balance in parallel, each point must find itself.
+ */
+static void find_nearest_test(int points_len, int random_seed)
+{
+  float(*points)[3] = points_random_create(points_len, random_seed);
+  KDTree_3d *tree = kdtree_create(points, points_len);
+
+  for (int i = 0; i < points_len; i++) {
+    KDTreeNearest_3d nearest;
+    EXPECT_NE(BLI_kdtree_3d_find_nearest(tree, points[i], &nearest), -1);
+    EXPECT_EQ(nearest.dist, 0.0f);
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+}
+
+TEST(kdtree, FindNearest_1)
+{
+  find_nearest_test(1, 1234);
+}
+TEST(kdtree, FindNearest_100000)
+{
+  find_nearest_test(100000, 12);
+}
+
+/**
+ * Batched searches must find the same points as searching for each coordinate on its own.
+ */
+TEST(kdtree, FindNearestNBatch)
+{
+  const int points_len = 20000, queries_len = 1000, nearest_len_capacity = 8;
+  float(*points)[3] = points_random_create(points_len, 12);
+  float(*queries)[3] = points_random_create(queries_len, 1234);
+  KDTree_3d *tree = kdtree_create(points, points_len);
+
+  KDTreeNearest_3d *nearest = (KDTreeNearest_3d *)MEM_mallocN(
+      sizeof(*nearest) * queries_len * nearest_len_capacity, __func__);
+  int *nearest_len = (int *)MEM_mallocN(sizeof(int) * queries_len, __func__);
+  BLI_kdtree_3d_find_nearest_n_batch(
+      tree, queries, queries_len, nearest, nearest_len, nearest_len_capacity);
+
+  for (int i = 0; i < queries_len; i++) {
+    KDTreeNearest_3d nearest_single[nearest_len_capacity];
+    const int nearest_single_len = BLI_kdtree_3d_find_nearest_n(
+        tree, queries[i], nearest_single, nearest_len_capacity);
+    EXPECT_EQ(nearest_len[i], nearest_single_len);
+    for (int j = 0; j < nearest_single_len; j++) {
+      EXPECT_EQ(nearest[i * nearest_len_capacity + j].dist, nearest_single[j].dist);
+    }
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+  MEM_freeN(queries);
+  MEM_freeN(nearest);
+  MEM_freeN(nearest_len);
+}
+
+static bool range_search_count_cb(void *user_data,
+                                  int UNUSED(index),
+                                  const float UNUSED(co[3]),
+                                  float UNUSED(dist_sq))
+{
+  (*(int *)user_data)++;
+  return true;
+}
+
+static bool range_search_batch_count_cb(void *user_data,
+                                        int co_index,
+                                        int UNUSED(index),
+                                        const float UNUSED(co[3]),
+                                        float UNUSED(dist_sq))
+{
+  ((int *)user_data)[co_index]++;
+  return true;
+}
+
+TEST(kdtree, RangeSearchBatch)
+{
+  const int points_len = 20000, queries_len = 1000;
+  const float range = 0.1f;
+  float(*points)[3] = points_random_create(points_len, 12);
+  float(*queries)[3] = points_random_create(queries_len, 1234);
+  KDTree_3d *tree = kdtree_create(points, points_len);
+
+  int *found_len = (int *)MEM_callocN(sizeof(int) * queries_len, __func__);
+  BLI_kdtree_3d_range_search_cb_batch(
+      tree, queries, queries_len, range, range_search_batch_count_cb, found_len);
+
+  for (int i = 0; i < queries_len; i++) {
+    int found_single_len = 0;
+    BLI_kdtree_3d_range_search_cb(
+        tree, queries[i], range, range_search_count_cb, &found_single_len);
+    EXPECT_EQ(found_len[i], found_single_len);
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+  MEM_freeN(queries);
+  MEM_freeN(found_len);
+}
@@ -2,6 +2,7 @@
 
 #include "testing/testing.h"
 
+#include "BLI_ghash.h"
 #include "BLI_session_uuid.h"
 
 TEST(SessionUUID, GenerateBasic)
@@ -18,3 +19,20 @@ TEST(SessionUUID, GenerateBasic)
     EXPECT_FALSE(BLI_session_uuid_is_equal(&uuid1, &uuid2));
   }
 }
+
+TEST(SessionUUID, GHashLookup)
+{
+  const SessionUUID uuid1 = BLI_session_uuid_generate();
+  const SessionUUID uuid2 = BLI_session_uuid_generate();
+  int value1 = 1;
+
+  GHash *ghash = BLI_ghash_new(
+      BLI_session_uuid_ghash_hash, BLI_session_uuid_ghash_compare, __func__);
+  BLI_ghash_insert(ghash, (void *)&uuid1, &value1);
+
+  const SessionUUID uuid1_copy = uuid1;
+  EXPECT_EQ(BLI_ghash_lookup(ghash, &uuid1_copy), &value1);
+  EXPECT_EQ(BLI_ghash_lookup(ghash, &uuid2), nullptr);
+
+  BLI_ghash_free(ghash, nullptr, nullptr);
+}
@@ -65,6 +65,55 @@ TEST(task, RangeIter)
   BLI_threadapi_exit();
 }
 
+/* *** Scratch memory of parallel range iterations. *** */
+
+static void task_range_scratch_func(void *userdata,
+                                    int index,
+                                    const TaskParallelTLS *__restrict tls)
+{
+  int *data = (int *)userdata;
+  /* Sizes vary between iterations, to check the arena is reused correctly. */
+  const int buf_len = 1 + (index % 1000);
+  int *buf = (int *)BLI_task_parallel_scratch_calloc(tls, sizeof(*buf) * buf_len);
+  for (int i = 0; i < buf_len; i++) {
+    EXPECT_EQ(buf[i], 0);
+    buf[i] = index;
+  }
+  int *item = (int *)BLI_task_parallel_scratch_alloc(tls, sizeof(*item));
+  *item = buf[buf_len - 1];
+  data[index] = *item;
+}
+
+TEST(task, RangeScratch)
+{
+  int data[NUM_ITEMS] = {0};
+
+  BLI_threadapi_init();
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  uint64_t allocations_num_prev, arenas_num_prev;
+  BLI_task_parallel_scratch_stats_get(&allocations_num_prev, &arenas_num_prev);
+
+  BLI_task_parallel_range(0, NUM_ITEMS, data, task_range_scratch_func, &settings);
+
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    EXPECT_EQ(data[i], i);
+  }
+
+  /* All arenas are freed and accounted for once the range is done. */
+  uint64_t allocations_num, arenas_num;
+  BLI_task_parallel_scratch_stats_get(&allocations_num, &arenas_num);
+  EXPECT_EQ(allocations_num - allocations_num_prev, NUM_ITEMS * 2);
+  EXPECT_GE(arenas_num - arenas_num_prev, 1);
+  /* One arena per worker thread, not per block of iterations. */
+  EXPECT_LE(arenas_num - arenas_num_prev, (uint64_t)BLI_task_scheduler_num_threads());
+
+  BLI_threadapi_exit();
+}
+
 /* *** Parallel iterations over mempool items. *** */
 
 static void task_mempool_iter_func(void *userdata, MempoolIterData *item)
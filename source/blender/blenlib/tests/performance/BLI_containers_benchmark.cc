@@ -0,0 +1,173 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_ghash.h"
+#include "BLI_map.hh"
+#include "BLI_mempool.h"
+#include "BLI_rand.hh"
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "benchmark.hh"
+
+namespace blender::tests {
+
+#define CONTAINERS_KEYS_NUM 1000000
+
+static Vector<int> random_keys(int64_t keys_num)
+{
+  RandomNumberGenerator rng(0);
+  Vector<int> keys(keys_num);
+  for (int &key : keys) {
+    key = rng.get_int32();
+  }
+  return keys;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Vector
+ * \{ */
+
+TEST(blenlib_performance, vector)
+{
+  benchmark("vector_append_int", CONTAINERS_KEYS_NUM, []() {
+    Vector<int> vector;
+    for (int i = 0; i < CONTAINERS_KEYS_NUM; i++) {
+      vector.append(i);
+    }
+    EXPECT_EQ(vector.size(), CONTAINERS_KEYS_NUM);
+  });
+
+  Vector<int> vector(CONTAINERS_KEYS_NUM, 1);
+  benchmark("vector_iterate_int", CONTAINERS_KEYS_NUM, [&]() {
+    int64_t sum = 0;
+    for (const int value : vector) {
+      sum += value;
+    }
+    EXPECT_EQ(sum, CONTAINERS_KEYS_NUM);
+  });
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Map & Set
+ * \{ */
+
+TEST(blenlib_performance, map)
+{
+  const Vector<int> keys = random_keys(CONTAINERS_KEYS_NUM);
+
+  benchmark("map_add_int", keys.size(), [&]() {
+    Map<int, int> map;
+    for (const int key : keys) {
+      map.add(key, key);
+    }
+  });
+
+  Map<int, int> map;
+  for (const int key : keys) {
+    map.add(key, key);
+  }
+  benchmark("map_lookup_int", keys.size(), [&]() {
+    int64_t found = 0;
+    for (const int key : keys) {
+      found += map.lookup_ptr(key) != nullptr;
+    }
+    EXPECT_EQ(found, keys.size());
+  });
+}
+
+TEST(blenlib_performance, set)
+{
+  const Vector<int> keys = random_keys(CONTAINERS_KEYS_NUM);
+
+  benchmark("set_add_int", keys.size(), [&]() {
+    Set<int> set;
+    for (const int key : keys) {
+      set.add(key);
+    }
+  });
+
+  Set<int> set;
+  for (const int key : keys) {
+    set.add(key);
+  }
+  benchmark("set_contains_int", keys.size(), [&]() {
+    int64_t found = 0;
+    for (const int key : keys) {
+      found += set.contains(key);
+    }
+    EXPECT_EQ(found, keys.size());
+  });
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name GHash
+ * \{ */
+
+TEST(blenlib_performance, ghash)
+{
+  const Vector<int> keys = random_keys(CONTAINERS_KEYS_NUM);
+
+  benchmark("ghash_insert_int", keys.size(), [&]() {
+    GHash *ghash = BLI_ghash_int_new_ex(__func__, (uint)keys.size());
+    for (const int key : keys) {
+      BLI_ghash_reinsert(ghash, POINTER_FROM_INT(key), POINTER_FROM_INT(key), nullptr, nullptr);
+    }
+    BLI_ghash_free(ghash, nullptr, nullptr);
+  });
+
+  GHash *ghash = BLI_ghash_int_new_ex(__func__, (uint)keys.size());
+  for (const int key : keys) {
+    BLI_ghash_reinsert(ghash, POINTER_FROM_INT(key), POINTER_FROM_INT(key), nullptr, nullptr);
+  }
+  benchmark("ghash_lookup_int", keys.size(), [&]() {
+    int64_t found = 0;
+    for (const int key : keys) {
+      found += BLI_ghash_haskey(ghash, POINTER_FROM_INT(key));
+    }
+    EXPECT_EQ(found, keys.size());
+  });
+  BLI_ghash_free(ghash, nullptr, nullptr);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Memory Pool
+ * \{ */
+
+TEST(blenlib_performance, mempool)
+{
+  Vector<void *> elements(CONTAINERS_KEYS_NUM);
+
+  benchmark("mempool_alloc_free", CONTAINERS_KEYS_NUM, [&]() {
+    BLI_mempool *pool = BLI_mempool_create(sizeof(float[4]), 0, 512, BLI_MEMPOOL_NOP);
+    for (void *&elem : elements) {
+      elem = BLI_mempool_alloc(pool);
+    }
+    for (void *elem : elements) {
+      BLI_mempool_free(pool, elem);
+    }
+    BLI_mempool_destroy(pool);
+  });
+
+  benchmark("guardedalloc_alloc_free", CONTAINERS_KEYS_NUM, [&]() {
+    for (void *&elem : elements) {
+      elem = MEM_mallocN(sizeof(float[4]), __func__);
+    }
+    for (void *elem : elements) {
+      MEM_freeN(elem);
+    }
+  });
+}
+
+/** \} */
+
+}  // namespace blender::tests
@@ -0,0 +1,162 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_edgehash.h"
+#include "BLI_ghash.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+
+/* Compare #EdgeHash and #EdgeSet with a #GHash using the same edges packed into pointer keys,
+ * on edges of a grid (as in typical meshes) and on random edges. */
+
+#define GRID_SIZE_SMALL 100
+#define GRID_SIZE_BIG 1000
+
+static uint grid_edges_fill(uint (*edges)[2], const uint grid_size)
+{
+  uint edges_len = 0;
+  for (uint y = 0; y < grid_size; y++) {
+    for (uint x = 0; x < grid_size; x++) {
+      const uint v = y * grid_size + x;
+      if (x + 1 < grid_size) {
+        edges[edges_len][0] = v;
+        edges[edges_len][1] = v + 1;
+        edges_len++;
+      }
+      if (y + 1 < grid_size) {
+        edges[edges_len][0] = v + grid_size;
+        edges[edges_len][1] = v;
+        edges_len++;
+      }
+    }
+  }
+  return edges_len;
+}
+
+static uint random_edges_fill(uint (*edges)[2], const uint edges_len, const uint verts_len)
+{
+  RNG *rng = BLI_rng_new(0);
+  for (uint i = 0; i < edges_len; i++) {
+    edges[i][0] = BLI_rng_get_uint(rng) % verts_len;
+    do {
+      edges[i][1] = BLI_rng_get_uint(rng) % verts_len;
+    } while (edges[i][1] == edges[i][0]);
+  }
+  BLI_rng_free(rng);
+  return edges_len;
+}
+
+static void *edge_as_ghash_key(const uint v0, const uint v1)
+{
+  const uint64_t v_low = MIN2(v0, v1);
+  const uint64_t v_high = MAX2(v0, v1);
+  return (void *)(uintptr_t)((v_low << 32) | v_high);
+}
+
+static void edgehash_tests(const uint (*edges)[2], const uint edges_len, const char *id)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  {
+    EdgeHash *eh = BLI_edgehash_new(__func__);
+
+    TIMEIT_START(edgehash_insert);
+    for (uint i = 0; i < edges_len; i++) {
+      void **value;
+      if (!BLI_edgehash_ensure_p(eh, edges[i][0], edges[i][1], &value)) {
+        *value = POINTER_FROM_UINT(i);
+      }
+    }
+    TIMEIT_END(edgehash_insert);
+
+    TIMEIT_START(edgehash_lookup);
+    for (uint i = 0; i < edges_len; i++) {
+      EXPECT_TRUE(BLI_edgehash_haskey(eh, edges[i][0], edges[i][1]));
+    }
+    TIMEIT_END(edgehash_lookup);
+
+    TIMEIT_START(edgehash_lookup_missing);
+    for (uint i = 0; i < edges_len; i++) {
+      EXPECT_FALSE(BLI_edgehash_haskey(eh, edges[i][0] + (1u << 30), edges[i][1]));
+    }
+    TIMEIT_END(edgehash_lookup_missing);
+
+    BLI_edgehash_free(eh, NULL);
+  }
+
+  {
+    EdgeSet *es = BLI_edgeset_new(__func__);
+
+    TIMEIT_START(edgeset_add);
+    for (uint i = 0; i < edges_len; i++) {
+      BLI_edgeset_add(es, edges[i][0], edges[i][1]);
+    }
+    TIMEIT_END(edgeset_add);
+
+    TIMEIT_START(edgeset_lookup);
+    for (uint i = 0; i < edges_len; i++) {
+      EXPECT_TRUE(BLI_edgeset_haskey(es, edges[i][0], edges[i][1]));
+    }
+    TIMEIT_END(edgeset_lookup);
+
+    BLI_edgeset_free(es);
+  }
+
+  {
+    GHash *gh = BLI_ghash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+
+    TIMEIT_START(ghash_insert);
+    for (uint i = 0; i < edges_len; i++) {
+      void **value;
+      if (!BLI_ghash_ensure_p(gh, edge_as_ghash_key(edges[i][0], edges[i][1]), &value)) {
+        *value = POINTER_FROM_UINT(i);
+      }
+    }
+    TIMEIT_END(ghash_insert);
+
+    TIMEIT_START(ghash_lookup);
+    for (uint i = 0; i < edges_len; i++) {
+      EXPECT_TRUE(BLI_ghash_haskey(gh, edge_as_ghash_key(edges[i][0], edges[i][1])));
+    }
+    TIMEIT_END(ghash_lookup);
+
+    BLI_ghash_free(gh, NULL, NULL);
+  }
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+static void grid_edgehash_tests(const uint grid_size, const char *id)
+{
+  uint(*edges)[2] = (uint(*)[2])MEM_mallocN(sizeof(*edges) * grid_size * grid_size * 2, __func__);
+  const uint edges_len = grid_edges_fill(edges, grid_size);
+  edgehash_tests(edges, edges_len, id);
+  MEM_freeN(edges);
+}
+
+static void random_edgehash_tests(const uint edges_len, const char *id)
+{
+  uint(*edges)[2] = (uint(*)[2])MEM_mallocN(sizeof(*edges) * edges_len, __func__);
+  random_edges_fill(edges, edges_len, edges_len);
+  edgehash_tests(edges, edges_len, id);
+  MEM_freeN(edges);
+}
+
+TEST(edgehash, GridSmall)
+{
+  grid_edgehash_tests(GRID_SIZE_SMALL, "Grid - 100x100");
+}
+
+TEST(edgehash, GridBig)
+{
+  grid_edgehash_tests(GRID_SIZE_BIG, "Grid - 1000x1000");
+}
+
+TEST(edgehash, Random2000000)
+{
+  random_edgehash_tests(2000000, "Random - 2000000");
+}
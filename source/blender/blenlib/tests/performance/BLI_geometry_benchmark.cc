@@ -0,0 +1,219 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_delaunay_2d.h"
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_kdopbvh.h"
+#include "BLI_kdtree.h"
+#include "BLI_math_base.h"
+#include "BLI_memarena.h"
+#include "BLI_polyfill_2d.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include "benchmark.hh"
+
+namespace blender::tests {
+
+#define GEOMETRY_POINTS_NUM 200000
+#define GEOMETRY_QUERIES_NUM 100000
+
+/** Random coordinates in the (-1, 1) cube. */
+static Vector<float3> random_points(int64_t points_num, uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Vector<float3> points(points_num);
+  for (float3 &point : points) {
+    point = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f - float3(1.0f);
+  }
+  return points;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name KD-Tree
+ * \{ */
+
+TEST(blenlib_performance, kdtree)
+{
+  const Vector<float3> points = random_points(GEOMETRY_POINTS_NUM, 0);
+  const Vector<float3> queries = random_points(GEOMETRY_QUERIES_NUM, 1);
+  KDTree_3d *tree = nullptr;
+
+  /* Only the balancing is timed, the tree has to be filled again before every run. */
+  benchmark(
+      "kdtree_balance",
+      points.size(),
+      [&]() {
+        if (tree) {
+          BLI_kdtree_3d_free(tree);
+        }
+        tree = BLI_kdtree_3d_new((uint)points.size());
+        for (const int i : points.index_range()) {
+          BLI_kdtree_3d_insert(tree, i, points[i]);
+        }
+      },
+      [&]() { BLI_kdtree_3d_balance(tree); });
+
+  benchmark("kdtree_find_nearest", queries.size(), [&]() {
+    for (const float3 &query : queries) {
+      KDTreeNearest_3d nearest;
+      BLI_kdtree_3d_find_nearest(tree, query, &nearest);
+    }
+  });
+
+  Vector<KDTreeNearest_3d> nearest(queries.size());
+  Vector<int> nearest_len(queries.size());
+  benchmark("kdtree_find_nearest_batch", queries.size(), [&]() {
+    BLI_kdtree_3d_find_nearest_n_batch(tree,
+                                       (const float(*)[3])queries.data(),
+                                       (uint)queries.size(),
+                                       nearest.data(),
+                                       nearest_len.data(),
+                                       1);
+  });
+
+  BLI_kdtree_3d_free(tree);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name BVH-Tree
+ * \{ */
+
+/** Every leaf is a small box, so rays can hit them without a callback. */
+#define BVH_LEAF_SIZE 0.01f
+
+static BVHTree *bvhtree_from_points(Span<float3> points)
+{
+  BVHTree *tree = BLI_bvhtree_new((int)points.size(), 0.0f, 4, 8);
+  for (const int i : points.index_range()) {
+    const float3 co[2] = {points[i], points[i] + float3(BVH_LEAF_SIZE)};
+    BLI_bvhtree_insert(tree, i, (const float *)co, 2);
+  }
+  return tree;
+}
+
+TEST(blenlib_performance, bvhtree)
+{
+  const Vector<float3> points = random_points(GEOMETRY_POINTS_NUM, 0);
+  const Vector<float3> queries = random_points(GEOMETRY_QUERIES_NUM, 1);
+  BVHTree *tree = nullptr;
+
+  benchmark(
+      "bvhtree_balance",
+      points.size(),
+      [&]() {
+        if (tree) {
+          BLI_bvhtree_free(tree);
+        }
+        tree = bvhtree_from_points(points);
+      },
+      [&]() { BLI_bvhtree_balance(tree); });
+
+  Vector<BVHTreeNearest> nearest(queries.size());
+  auto nearest_reset = [&]() {
+    for (BVHTreeNearest &n : nearest) {
+      n.index = -1;
+      n.dist_sq = FLT_MAX;
+    }
+  };
+
+  benchmark("bvhtree_find_nearest", queries.size(), nearest_reset, [&]() {
+    for (const int i : queries.index_range()) {
+      BLI_bvhtree_find_nearest(tree, queries[i], &nearest[i], nullptr, nullptr);
+    }
+  });
+  benchmark("bvhtree_find_nearest_batch", queries.size(), nearest_reset, [&]() {
+    BLI_bvhtree_find_nearest_batch(tree,
+                                   (const float(*)[3])queries.data(),
+                                   (int)queries.size(),
+                                   nearest.data(),
+                                   nullptr,
+                                   nullptr,
+                                   0);
+  });
+
+  /* Rays start on a sphere around the points and point to the opposite side. */
+  Vector<float3> ray_origins(queries.size());
+  Vector<float3> ray_directions(queries.size());
+  for (const int i : queries.index_range()) {
+    ray_directions[i] = queries[i].normalized();
+    ray_origins[i] = ray_directions[i] * -2.0f;
+  }
+  Vector<BVHTreeRayHit> hits(queries.size());
+  auto hits_reset = [&]() {
+    for (BVHTreeRayHit &hit : hits) {
+      hit.index = -1;
+      hit.dist = FLT_MAX;
+    }
+  };
+
+  benchmark("bvhtree_ray_cast", queries.size(), hits_reset, [&]() {
+    for (const int i : queries.index_range()) {
+      BLI_bvhtree_ray_cast(
+          tree, ray_origins[i], ray_directions[i], 0.0f, &hits[i], nullptr, nullptr);
+    }
+  });
+
+  BLI_bvhtree_free(tree);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Polygon Fill & Delaunay Triangulation
+ * \{ */
+
+#define POLYFILL_VERTS_NUM 10000
+#define DELAUNAY_VERTS_NUM 10000
+
+TEST(blenlib_performance, polyfill)
+{
+  /* A star shaped polygon, so most corners are concave. */
+  Vector<float2> coords(POLYFILL_VERTS_NUM);
+  for (const int i : coords.index_range()) {
+    const float angle = (float)i * (float)(M_PI * 2.0) / (float)POLYFILL_VERTS_NUM;
+    const float radius = (i % 2) ? 1.0f : 0.5f;
+    coords[i] = float2(cosf(angle), sinf(angle)) * radius;
+  }
+  Vector<uint> tris((POLYFILL_VERTS_NUM - 2) * 3);
+  MemArena *arena = BLI_memarena_new(BLI_POLYFILL_ARENA_SIZE, __func__);
+
+  benchmark("polyfill_star", coords.size(), [&]() {
+    BLI_polyfill_calc_arena((const float(*)[2])coords.data(),
+                            (uint)coords.size(),
+                            0,
+                            (uint(*)[3])tris.data(),
+                            arena);
+    BLI_memarena_clear(arena);
+  });
+
+  BLI_memarena_free(arena);
+}
+
+TEST(blenlib_performance, delaunay)
+{
+  RandomNumberGenerator rng(0);
+  Vector<float2> coords(DELAUNAY_VERTS_NUM);
+  for (float2 &co : coords) {
+    co = float2(rng.get_float(), rng.get_float());
+  }
+
+  CDT_input input = {0};
+  input.verts_len = (int)coords.size();
+  input.vert_coords = (float(*)[2])coords.data();
+
+  benchmark("delaunay_random_points", coords.size(), [&]() {
+    CDT_result *result = BLI_delaunay_2d_cdt_calc(&input, CDT_FULL);
+    BLI_delaunay_2d_cdt_free(result);
+  });
+}
+
+/** \} */
+
+}  // namespace blender::tests
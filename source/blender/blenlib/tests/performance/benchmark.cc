@@ -0,0 +1,179 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+
+#include "BLI_threads.h"
+#include "BLI_vector.hh"
+
+#include "benchmark.hh"
+
+DEFINE_string(benchmark_out, "", "Write the benchmark results as JSON to this file.");
+DEFINE_double(benchmark_min_time, 0.5, "Minimum time in seconds to run each benchmark for.");
+
+namespace blender::tests {
+
+using Clock = std::chrono::steady_clock;
+
+/* Every benchmark is run at least this often, even when a single run takes longer than
+ * `--benchmark_min_time`. The limit avoids very long runs of extremely fast benchmarks. */
+static constexpr int64_t BENCHMARK_RUNS_MIN = 3;
+static constexpr int64_t BENCHMARK_RUNS_MAX = 1000;
+
+struct BenchmarkResult {
+  std::string name;
+  int64_t items_num;
+  int64_t runs_num;
+  /** Times of a single run in seconds. */
+  double time_min;
+  double time_median;
+  double cpu_time_median;
+};
+
+static Vector<BenchmarkResult> &benchmark_results()
+{
+  static Vector<BenchmarkResult> results;
+  return results;
+}
+
+static double median(MutableSpan<double> values)
+{
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+void benchmark(StringRef name,
+               int64_t items_num,
+               const std::function<void()> &setup,
+               const std::function<void()> &fn)
+{
+  Vector<double> times;
+  Vector<double> cpu_times;
+  double time_total = 0.0;
+
+  /* Warm up caches and allocators, the first run is often much slower. */
+  if (setup) {
+    setup();
+  }
+  fn();
+
+  while (times.size() < BENCHMARK_RUNS_MAX &&
+         (times.size() < BENCHMARK_RUNS_MIN || time_total < FLAGS_benchmark_min_time)) {
+    if (setup) {
+      setup();
+    }
+    const std::clock_t cpu_start = std::clock();
+    const Clock::time_point start = Clock::now();
+    fn();
+    const Clock::time_point end = Clock::now();
+    const std::clock_t cpu_end = std::clock();
+
+    const double time = std::chrono::duration<double>(end - start).count();
+    times.append(time);
+    cpu_times.append((double)(cpu_end - cpu_start) / CLOCKS_PER_SEC);
+    time_total += time;
+  }
+
+  BenchmarkResult result;
+  result.name = name;
+  result.items_num = items_num;
+  result.runs_num = times.size();
+  result.time_min = *std::min_element(times.begin(), times.end());
+  result.time_median = median(times);
+  result.cpu_time_median = median(cpu_times);
+
+  printf("%-40s %12.3f ms (min %12.3f ms) %14.0f items/s %6d runs\n",
+         result.name.c_str(),
+         result.time_median * 1e3,
+         result.time_min * 1e3,
+         (double)result.items_num / result.time_median,
+         (int)result.runs_num);
+  fflush(stdout);
+
+  benchmark_results().append(std::move(result));
+}
+
+void benchmark(StringRef name, int64_t items_num, const std::function<void()> &fn)
+{
+  benchmark(name, items_num, nullptr, fn);
+}
+
+static std::string json_escape(StringRef str)
+{
+  std::string result;
+  for (const char c : str) {
+    if (ELEM(c, '"', '\\')) {
+      result += '\\';
+    }
+    result += c;
+  }
+  return result;
+}
+
+static void benchmark_results_write_json(const std::string &filepath)
+{
+  std::ofstream file(filepath);
+  if (!file) {
+    ADD_FAILURE() << "Could not write benchmark results to \"" << filepath << "\"";
+    return;
+  }
+  file.precision(15);
+
+  char date[64];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+  file << "{\n";
+  file << "  \"context\": {\n";
+  file << "    \"date\": \"" << date << "\",\n";
+  file << "    \"num_cpus\": " << BLI_system_thread_count() << ",\n";
+#ifdef NDEBUG
+  file << "    \"library_build_type\": \"release\"\n";
+#else
+  file << "    \"library_build_type\": \"debug\"\n";
+#endif
+  file << "  },\n";
+  file << "  \"benchmarks\": [";
+
+  const Span<BenchmarkResult> results = benchmark_results();
+  for (const int64_t i : results.index_range()) {
+    const BenchmarkResult &result = results[i];
+    const std::string name = json_escape(result.name);
+    file << ((i == 0) ? "\n" : ",\n");
+    file << "    {\n";
+    file << "      \"name\": \"" << name << "\",\n";
+    file << "      \"run_name\": \"" << name << "\",\n";
+    file << "      \"run_type\": \"iteration\",\n";
+    file << "      \"iterations\": " << result.runs_num << ",\n";
+    file << "      \"real_time\": " << result.time_median * 1e9 << ",\n";
+    file << "      \"real_time_min\": " << result.time_min * 1e9 << ",\n";
+    file << "      \"cpu_time\": " << result.cpu_time_median * 1e9 << ",\n";
+    file << "      \"time_unit\": \"ns\",\n";
+    file << "      \"items_per_second\": " << (double)result.items_num / result.time_median
+         << "\n";
+    file << "    }";
+  }
+  file << "\n  ]\n";
+  file << "}\n";
+}
+
+/** Writes the results once all benchmarks have run. */
+class BenchmarkEnvironment : public ::testing::Environment {
+ public:
+  void TearDown() override
+  {
+    if (!FLAGS_benchmark_out.empty()) {
+      benchmark_results_write_json(FLAGS_benchmark_out);
+    }
+  }
+};
+
+static ::testing::Environment *const benchmark_environment =
+    ::testing::AddGlobalTestEnvironment(new BenchmarkEnvironment());
+
+}  // namespace blender::tests
@@ -0,0 +1,40 @@
+/* Apache License, Version 2.0 */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Minimal benchmark harness for the `blenlib_performance` test, built on top of gtest so it needs
+ * no extra dependency. Every benchmark runs its function repeatedly and reports the fastest and
+ * the median time of a single run.
+ *
+ * Results are printed, and written as JSON when `--benchmark_out=<file>` is passed. The JSON
+ * uses the same layout as Google Benchmark, so its `compare.py` tool can be used to compare two
+ * builds.
+ *
+ * Use a gtest filter to run a subset, e.g. `--gtest_filter=*kdtree*`.
+ */
+
+#include <functional>
+
+#include "BLI_string_ref.hh"
+
+namespace blender::tests {
+
+/**
+ * Time \a fn, \a items_num is the number of elements processed by a single call and is only used
+ * to report the throughput.
+ */
+void benchmark(StringRef name, int64_t items_num, const std::function<void()> &fn);
+
+/**
+ * Same as above, but \a setup is called before every run of \a fn and is not timed. This is
+ * useful when \a fn consumes its input, e.g. to balance a tree that has to be filled first.
+ */
+void benchmark(StringRef name,
+               int64_t items_num,
+               const std::function<void()> &setup,
+               const std::function<void()> &fn);
+
+}  // namespace blender::tests
@@ -34,6 +34,12 @@ typedef struct {
   unsigned int size;
   /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
   bool is_identical;
+  /**
+   * When true, this chunk doesn't own the memory either, it's shared with a #MemFileChunk of the
+   * previous step that has the same content but a different position (or ID), so unlike
+   * #is_identical it does not mean the data is unchanged.
+   */
+  bool is_deduplicated;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
@@ -41,6 +47,8 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the chunk contents, used to find duplicate chunks. */
+  uint content_hash;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -57,6 +65,8 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Set of all chunks of the reference memfile, looked up by content. */
+  struct GSet *reference_chunks_by_content;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -78,6 +88,8 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, unsigned
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
 extern void BLO_memfile_clear_future(MemFile *memfile);
+extern MemFile *BLO_memfile_share(const MemFile *memfile);
+extern void BLO_memfile_share_release(MemFile *memfile_shared);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
@@ -107,6 +107,8 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -318,6 +320,8 @@ static const char *library_parent_filepath(Library *lib)
 
 /* -------------------------------------------------------------------- */
 /** \name OldNewMap API
+ *
+ * Maps pointers stored in the file to the newly allocated data.
  * \{ */
 
 typedef struct OldNew {
@@ -400,9 +404,9 @@ static void oldnewmap_clear_map(OldNewMap *onm)
   memset(onm->map, 0xFF, MAP_CAPACITY(onm) * sizeof(*onm->map));
 }
 
-static void oldnewmap_increase_size(OldNewMap *onm)
+static void oldnewmap_resize(OldNewMap *onm, int capacity_exp)
 {
-  onm->capacity_exp++;
+  onm->capacity_exp = capacity_exp;
   onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * ENTRIES_CAPACITY(onm));
   onm->map = MEM_reallocN(onm->map, sizeof(*onm->map) * MAP_CAPACITY(onm));
   oldnewmap_clear_map(onm);
@@ -411,6 +415,11 @@ static void oldnewmap_increase_size(OldNewMap *onm)
   }
 }
 
+static void oldnewmap_increase_size(OldNewMap *onm)
+{
+  oldnewmap_resize(onm, onm->capacity_exp + 1);
+}
+
 /* Public OldNewMap API */
 
 static OldNewMap *oldnewmap_new(void)
@@ -448,6 +457,21 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void
   oldnewmap_insert(onm, oldaddr, newaddr, nr);
 }
 
+/**
+ * Grow the map at once so that \a nentries entries in total can be inserted,
+ * instead of rehashing all entries every time the capacity doubles.
+ */
+static void oldnewmap_reserve(OldNewMap *onm, int nentries)
+{
+  int capacity_exp = onm->capacity_exp;
+  while (nentries > (1ll << capacity_exp)) {
+    capacity_exp++;
+  }
+  if (capacity_exp != onm->capacity_exp) {
+    oldnewmap_resize(onm, capacity_exp);
+  }
+}
+
 static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
 {
   OldNew *entry = oldnewmap_lookup_entry(onm, addr);
@@ -513,11 +537,27 @@ static void oldnewmap_free(OldNewMap *onm)
 /** \name Helper Functions
  * \{ */
 
+/**
+ * Free the ID name lookup map used by #is_yet_read,
+ * needed whenever IDs are removed from \a mainvar or moved between mains.
+ * It is lazily re-created on the next lookup.
+ */
+static void main_id_map_clear(Main *mainvar)
+{
+  if (mainvar->id_map != NULL) {
+    BKE_main_idmap_destroy(mainvar->id_map);
+    mainvar->id_map = NULL;
+  }
+}
+
 static void add_main_to_main(Main *mainvar, Main *from)
 {
   ListBase *lbarray[MAX_LIBARRAY], *fromarray[MAX_LIBARRAY];
   int a;
 
+  main_id_map_clear(mainvar);
+  main_id_map_clear(from);
+
   set_listbasepointers(mainvar, lbarray);
   a = set_listbasepointers(from, fromarray);
   while (a--) {
@@ -564,6 +604,8 @@ void blo_split_main(ListBase *mainlist, Main *main)
   mainlist->first = mainlist->last = main;
   main->next = NULL;
 
+  main_id_map_clear(main);
+
   if (BLI_listbase_is_empty(&main->libraries)) {
     return;
   }
@@ -1027,6 +1069,29 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   }
   return &new_bhead_data->bhead;
 }
+
+/**
+ * Access the data of a block that hasn't been read yet directly in the memory-mapped file.
+ * This avoids an intermediate copy when the data is converted anyway.
+ *
+ * \return NULL when the data needs to be read with #blo_bhead_read_full instead.
+ */
+static const void *blo_bhead_data_from_mmap(FileData *fd, BHead *thisblock)
+{
+#  ifndef WIN32
+  if (fd->mmap_file != NULL) {
+    BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+    BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+    if (new_bhead->file_offset + new_bhead->bhead.len <= BLI_mmap_get_length(fd->mmap_file)) {
+      return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+    }
+  }
+#  else
+  /* IO errors are only handled inside #BLI_mmap_read on WIN32. */
+  UNUSED_VARS(fd, thisblock);
+#  endif
+  return NULL;
+}
 #endif /* USE_BHEAD_READ_ON_DEMAND */
 
 /* Warning! Caller's responsibility to ensure given bhead **is** and ID one! */
@@ -1084,6 +1149,10 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
   int subversion = 0;
 
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code != DATA) {
+      fd->id_bhead_len++;
+    }
+
     if (bhead->code == GLOB) {
       /* Before this, the subversion didn't exist in 'FileGlobal' so the subversion
        * value isn't accessible for the purpose of DNA versioning in this case. */
@@ -1107,8 +1176,12 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
       if (fd->filesdna) {
         blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
         fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
+        fd->reconstruct_info = DNA_reconstruct_info_create(
+            fd->filesdna, fd->memsdna, fd->compflags);
         /* used to retrieve ID names from (bhead+1) */
         fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
+        /* Every ID of the file gets an entry, avoid growing the map while reading. */
+        oldnewmap_reserve(fd->libmap, fd->id_bhead_len);
 
         return true;
       }
@@ -1195,6 +1268,53 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+/* Memory-mapped file reading.
+ * By only using it for uncompressed files, the data is only read from disk
+ * when it's actually accessed. Combined with #USE_BHEAD_READ_ON_DEMAND,
+ * data-blocks that are never needed (e.g. when linking from a library)
+ * are never paged in. */
+
+static int fd_read_from_mmap(FileData *filedata,
+                             void *buffer,
+                             uint size,
+                             bool *UNUSED(r_is_memchunck_identical))
+{
+  /* don't read more bytes then there are available in the mapping */
+  const size_t length = BLI_mmap_get_length(filedata->mmap_file);
+  const int readsize = (int)MIN2(size, (uint)(length - filedata->file_offset));
+
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, filedata->file_offset, readsize)) {
+    return EOF;
+  }
+  filedata->file_offset += readsize;
+
+  return readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t new_pos;
+  if (whence == SEEK_CUR) {
+    new_pos = filedata->file_offset + offset;
+  }
+  else if (whence == SEEK_SET) {
+    new_pos = offset;
+  }
+  else if (whence == SEEK_END) {
+    new_pos = BLI_mmap_get_length(filedata->mmap_file) + offset;
+  }
+  else {
+    return -1;
+  }
+
+  if (new_pos < 0 || new_pos > BLI_mmap_get_length(filedata->mmap_file)) {
+    return -1;
+  }
+
+  filedata->file_offset = new_pos;
+  return filedata->file_offset;
+}
+
 /* GZip file reading. */
 
 static int fd_read_gzip_from_file(FileData *filedata,
@@ -1357,6 +1477,7 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 {
   FileDataReadFn *read_fn = NULL;
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
+  BLI_mmap_file *mmap_file = NULL;
 
   gzFile gzfile = (gzFile)Z_NULL;
 
@@ -1377,8 +1498,17 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   /* Regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+    /* Try opening the file with memory-mapped IO, fall back to regular reads. */
+    mmap_file = BLI_mmap_open(file);
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    else {
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
+    BLI_lseek(file, 0, SEEK_SET);
   }
 
   /* Gzip file. */
@@ -1411,6 +1541,7 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->mmap_file = mmap_file;
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1481,7 +1612,21 @@ static int fd_read_gzip_from_memory(FileData *filedata,
   // Inflate another chunk.
   err = inflate(&filedata->strm, Z_SYNC_FLUSH);
 
+  /* Compressed files are written as multiple concatenated gzip members,
+   * continue with the next member when there is input left. */
+  while (err == Z_STREAM_END && filedata->strm.avail_in != 0 && filedata->strm.avail_out != 0) {
+    if (inflateReset(&filedata->strm) != Z_OK) {
+      printf("fd_read_gzip_from_memory: zlib error\n");
+      return 0;
+    }
+    err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  }
+
   if (err == Z_STREAM_END) {
+    if (filedata->strm.avail_out == 0) {
+      filedata->file_offset += size;
+      return size;
+    }
     return 0;
   }
   if (err != Z_OK) {
@@ -1571,6 +1716,11 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->mmap_file) {
+      BLI_mmap_free(fd->mmap_file);
+      fd->mmap_file = NULL;
+    }
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1601,6 +1751,9 @@ void blo_filedata_free(FileData *fd)
     if (fd->compflags) {
       MEM_freeN((void *)fd->compflags);
     }
+    if (fd->reconstruct_info) {
+      DNA_reconstruct_info_free(fd->reconstruct_info);
+    }
 
     if (fd->datamap) {
       oldnewmap_free(fd->datamap);
@@ -2143,20 +2296,116 @@ void blo_cache_storage_end(FileData *fd)
 /** \name DNA Struct Loading
  * \{ */
 
+/* Arrays of at least this many structs are converted in parallel,
+ * large mesh and custom-data blocks from old files are the common case. */
+#define READ_STRUCT_PARALLEL_MIN_BLOCKS 4096
+/* Number of structs converted by a single task. */
+#define READ_STRUCT_PARALLEL_CHUNK 1024
+
+typedef struct ReadStructParallelData {
+  const struct SDNA *oldsdna;
+  const struct DNA_ReconstructInfo *reconstruct_info;
+  int oldSDNAnr;
+  int blocks;
+  int blocksize;
+  char *data;
+  void *cur;
+} ReadStructParallelData;
+
+static void read_struct_parallel_settings(TaskParallelSettings *settings, const int blocks)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (blocks >= READ_STRUCT_PARALLEL_MIN_BLOCKS);
+  settings->min_iter_per_thread = 1;
+}
+
+static int read_struct_parallel_chunks(const int blocks)
+{
+  return (blocks + READ_STRUCT_PARALLEL_CHUNK - 1) / READ_STRUCT_PARALLEL_CHUNK;
+}
+
+static void switch_endian_structs_cb(void *__restrict userdata,
+                                     const int chunk,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ReadStructParallelData *data = userdata;
+  const int block_start = chunk * READ_STRUCT_PARALLEL_CHUNK;
+  const int block_end = MIN2(block_start + READ_STRUCT_PARALLEL_CHUNK, data->blocks);
+
+  char *cp = data->data + (size_t)block_start * data->blocksize;
+  for (int i = block_start; i < block_end; i++) {
+    DNA_struct_switch_endian(data->oldsdna, data->oldSDNAnr, cp);
+    cp += data->blocksize;
+  }
+}
+
 static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
 {
-  int blocksize, nblocks;
-  char *data;
+  ReadStructParallelData data = {
+      .oldsdna = filesdna,
+      .oldSDNAnr = bhead->SDNAnr,
+      .blocks = bhead->nr,
+      .blocksize = filesdna->types_size[filesdna->structs[bhead->SDNAnr][0]],
+      .data = (char *)(bhead + 1),
+  };
+
+  TaskParallelSettings settings;
+  read_struct_parallel_settings(&settings, data.blocks);
+  BLI_task_parallel_range(
+      0, read_struct_parallel_chunks(data.blocks), &data, switch_endian_structs_cb, &settings);
+}
 
-  data = (char *)(bhead + 1);
-  blocksize = filesdna->types_size[filesdna->structs[bhead->SDNAnr][0]];
+static void reconstruct_structs_cb(void *__restrict userdata,
+                                   const int chunk,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ReadStructParallelData *data = userdata;
+  const int block_start = chunk * READ_STRUCT_PARALLEL_CHUNK;
+  const int block_end = MIN2(block_start + READ_STRUCT_PARALLEL_CHUNK, data->blocks);
 
-  nblocks = bhead->nr;
-  while (nblocks--) {
-    DNA_struct_switch_endian(filesdna, bhead->SDNAnr, data);
+  DNA_struct_reconstruct_range(data->reconstruct_info,
+                               data->oldSDNAnr,
+                               block_start,
+                               block_end,
+                               data->data,
+                               data->cur);
+}
+
+/**
+ * Wrapper around #DNA_struct_reconstruct which splits the conversion
+ * of large struct arrays over multiple threads.
+ */
+static void *reconstruct_structs(FileData *fd, BHead *bh, const void *bh_data)
+{
+  if (bh->nr < READ_STRUCT_PARALLEL_MIN_BLOCKS) {
+    return DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, bh_data);
+  }
 
-    data += blocksize;
+  const struct SDNA *filesdna = fd->filesdna;
+  const char *type = filesdna->types[filesdna->structs[bh->SDNAnr][0]];
+  const int curSDNAnr = DNA_struct_find_nr(fd->memsdna, type);
+  if (curSDNAnr == -1) {
+    return NULL;
   }
+  const int curlen = fd->memsdna->types_size[fd->memsdna->structs[curSDNAnr][0]];
+  if (curlen == 0) {
+    return NULL;
+  }
+
+  ReadStructParallelData data = {
+      .reconstruct_info = fd->reconstruct_info,
+      .oldSDNAnr = bh->SDNAnr,
+      .blocks = bh->nr,
+      .data = (char *)bh_data,
+      .cur = MEM_callocN((size_t)bh->nr * curlen, "reconstruct"),
+  };
+
+  TaskParallelSettings settings;
+  read_struct_parallel_settings(&settings, data.blocks);
+  BLI_task_parallel_range(
+      0, read_struct_parallel_chunks(data.blocks), &data, reconstruct_structs_cb, &settings);
+
+  return data.cur;
 }
 
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
@@ -2184,17 +2433,26 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *bh_data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          bh_data = blo_bhead_data_from_mmap(fd, bh);
+          if (bh_data == NULL) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              return NULL;
+            }
+            bh_data = (bh + 1);
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(
-            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = reconstruct_structs(fd, bh, bh_data);
+
+        if (UNLIKELY(fd->mmap_file != NULL && BLI_mmap_any_io_error(fd->mmap_file))) {
+          fd->flags &= ~FD_FLAGS_FILE_OK;
+          MEM_SAFE_FREE(temp);
+        }
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -8740,6 +8998,10 @@ static ID *create_placeholder(Main *mainvar, const short idcode, const char *idn
 
   BKE_lib_libblock_session_uuid_ensure(ph_id);
 
+  if (mainvar->id_map != NULL) {
+    BKE_main_idmap_insert_id(mainvar->id_map, ph_id);
+  }
+
   return ph_id;
 }
 
@@ -8998,6 +9260,14 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
 {
   bhead = blo_bhead_next(fd, bhead);
 
+  /* Data-blocks such as node trees can own thousands of data blocks, size the map once. */
+  int data_len = 0;
+  for (BHead *bhead_data = bhead; bhead_data && bhead_data->code == DATA;
+       bhead_data = blo_bhead_next(fd, bhead_data)) {
+    data_len++;
+  }
+  oldnewmap_reserve(fd->datamap, fd->datamap->nentries + data_len);
+
   while (bhead && bhead->code == DATA) {
     /* The code below is useful for debugging leaks in data read from the blend file.
      * Without this the messages only tell us what ID-type the memory came from,
@@ -9282,6 +9552,8 @@ static BHead *read_libblock(FileData *fd,
    * address and inherit recalc flags for the dependency graph. */
   ID *id_old = NULL;
   if (fd->memfile != NULL) {
+    /* Restoring moves IDs from the old main, don't bother keeping the lookup map in sync. */
+    main_id_map_clear(main);
     if (read_libblock_undo_restore(fd, main, bhead, tag, &id_old)) {
       if (r_id) {
         *r_id = id_old;
@@ -9344,6 +9616,9 @@ static BHead *read_libblock(FileData *fd,
     }
 
     direct_link_id(fd, main, id_tag, id, id_old);
+    if (main->id_map != NULL) {
+      BKE_main_idmap_insert_id(main->id_map, id);
+    }
     return blo_bhead_next(fd, bhead);
   }
 
@@ -9368,6 +9643,15 @@ static BHead *read_libblock(FileData *fd,
     /* For undo, store contents read into id at id_old. */
     read_libblock_undo_restore_at_old_address(fd, main, id, id_old);
   }
+  else if (main->id_map != NULL) {
+    if (idcode == ID_LI) {
+      /* #direct_link_library may have removed duplicate libraries. */
+      main_id_map_clear(main);
+    }
+    else {
+      BKE_main_idmap_insert_id(main->id_map, id);
+    }
+  }
 
   return bhead;
 }
@@ -10152,9 +10436,18 @@ static BHead *find_bhead_from_idname(FileData *fd, const char *idname)
 
 static ID *is_yet_read(FileData *fd, Main *mainvar, BHead *bhead)
 {
+  /* Linking thousands of IDs does one lookup per expanded pointer,
+   * use a hash instead of searching the lists. */
+  if (mainvar->id_map == NULL) {
+    mainvar->id_map = BKE_main_idmap_create(mainvar, false, NULL, MAIN_IDMAP_TYPE_NAME);
+  }
+  BLI_assert(BKE_main_idmap_main_get(mainvar->id_map) == mainvar);
+
   const char *idname = blo_bhead_id_name(fd, bhead);
+  ID *id = BKE_main_idmap_lookup_name(mainvar->id_map, GS(idname), idname + 2, mainvar->curlib);
   /* which_libbase can be NULL, intentionally not using idname+2 */
-  return BLI_findstring(which_libbase(mainvar, GS(idname)), idname, offsetof(ID, name));
+  BLI_assert(id == BLI_findstring(which_libbase(mainvar, GS(idname)), idname, offsetof(ID, name)));
+  return id;
 }
 
 /** \} */
@@ -11666,6 +11959,8 @@ static void split_main_newid(Main *mainptr, Main *main_newid)
   BLI_strncpy(main_newid->name, mainptr->name, sizeof(main_newid->name));
   main_newid->curlib = mainptr->curlib;
 
+  main_id_map_clear(mainptr);
+
   ListBase *lbarray[MAX_LIBARRAY];
   ListBase *lbarray_newid[MAX_LIBARRAY];
   int i = set_listbasepointers(mainptr, lbarray);
@@ -11900,6 +12195,9 @@ static void read_library_linked_ids(FileData *basefd,
 {
   GHash *loaded_ids = BLI_ghash_str_new(__func__);
 
+  /* Placeholders are removed from the lists below. */
+  main_id_map_clear(mainvar);
+
   ListBase *lbarray[MAX_LIBARRAY];
   int a = set_listbasepointers(mainvar, lbarray);
 
@@ -12018,6 +12316,7 @@ static FileData *read_library_file_data(FileData *basefd,
     }
 
     fd->libmap = oldnewmap_new();
+    oldnewmap_reserve(fd->libmap, fd->id_bhead_len);
 
     mainptr->curlib->filedata = fd;
     mainptr->versionfile = fd->fileversion;
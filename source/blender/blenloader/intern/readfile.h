@@ -29,6 +29,7 @@
 #include "DNA_windowmanager_types.h" /* for ReportType */
 #include "zlib.h"
 
+struct BLI_mmap_file;
 struct BLOCacheStorage;
 struct GSet;
 struct IDNameLib_Map;
@@ -80,6 +81,8 @@ typedef struct FileData {
 
   /** Regular file reading. */
   int filedes;
+  /** Memory mapped regular file, when mapping succeeded. */
+  struct BLI_mmap_file *mmap_file;
 
   /** Variables needed for reading from memory / stream. */
   const char *buffer;
@@ -102,10 +105,14 @@ typedef struct FileData {
   const struct SDNA *memsdna;
   /** Array of #eSDNA_StructCompare. */
   const char *compflags;
+  /** Conversion steps for structs that differ between #filesdna and #memsdna. */
+  struct DNA_ReconstructInfo *reconstruct_info;
 
   int fileversion;
   /** Used to retrieve ID names from (bhead+1). */
   int id_name_offs;
+  /** Number of blocks in the file that are not #DATA, used to size #libmap. */
+  int id_bhead_len;
   /** For do_versions patching. */
   int globalf, fileflags;
 
@@ -42,6 +42,9 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_linklist.h"
+#include "BLI_threads.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -54,14 +57,35 @@
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* Whether the chunk owns its buffer, or shares it with a chunk of a previous step. */
+BLI_INLINE bool memfile_chunk_owns_buf(const MemFileChunk *chunk)
+{
+  return !(chunk->is_identical || chunk->is_deduplicated);
+}
+
+/**
+ * Memfiles shared with other threads through #BLO_memfile_share. While any of them is in use,
+ * buffers of freed chunks are kept in a list instead, they're only freed once the last shared
+ * memfile is released. Only accessed from the main thread.
+ */
+static int memfile_shared_users = 0;
+static LinkNode *memfile_shared_deferred_bufs = NULL;
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
+  BLI_assert(BLI_thread_is_main() || memfile_shared_users == 0);
+
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
+    if (memfile_chunk_owns_buf(chunk)) {
+      if (memfile_shared_users > 0) {
+        BLI_linklist_prepend(&memfile_shared_deferred_bufs, (void *)chunk->buf);
+      }
+      else {
+        MEM_freeN((void *)chunk->buf);
+      }
     }
     MEM_freeN(chunk);
   }
@@ -77,21 +101,26 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   GHash *buffer_to_second_memchunk = BLI_ghash_new(
       BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
 
-  /* First, detect all memchunks in second memfile that are not owned by it. */
+  /* First, detect all memchunks in second memfile that are not owned by it.
+   * Several de-duplicated chunks may share a buffer, only one of them has to take ownership. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+    if (!memfile_chunk_owns_buf(sc)) {
+      void **val_p;
+      if (!BLI_ghash_ensure_p(buffer_to_second_memchunk, (void *)sc->buf, &val_p)) {
+        *val_p = sc;
+      }
     }
   }
 
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
+    if (memfile_chunk_owns_buf(fc)) {
       MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
       if (sc != NULL) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(!memfile_chunk_owns_buf(sc));
         sc->is_identical = false;
+        sc->is_deduplicated = false;
         fc->is_identical = true;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
@@ -105,6 +134,54 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   BLO_memfile_free(first);
 }
 
+/**
+ * Create a memfile that references the buffers of \a memfile without copying them, so it can be
+ * written from another thread. The buffers stay valid when the original memfile (e.g. an undo
+ * step) is freed, until #BLO_memfile_share_release is called.
+ *
+ * Only the chunk headers are allocated, this doesn't depend on the size of the data.
+ */
+MemFile *BLO_memfile_share(const MemFile *memfile)
+{
+  BLI_assert(BLI_thread_is_main());
+
+  MemFile *memfile_shared = MEM_callocN(sizeof(*memfile_shared), __func__);
+
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    MemFileChunk *chunk_shared = MEM_mallocN(sizeof(*chunk_shared), __func__);
+    *chunk_shared = *chunk;
+    /* Never owns the buffer, see #memfile_chunk_owns_buf. */
+    chunk_shared->is_identical = true;
+    chunk_shared->is_deduplicated = false;
+    chunk_shared->is_identical_future = false;
+    BLI_addtail(&memfile_shared->chunks, chunk_shared);
+  }
+  memfile_shared->size = memfile->size;
+
+  memfile_shared_users++;
+
+  return memfile_shared;
+}
+
+/**
+ * Free a memfile created by #BLO_memfile_share, and the buffers which were freed in the meantime
+ * when no other shared memfile is in use anymore.
+ */
+void BLO_memfile_share_release(MemFile *memfile_shared)
+{
+  BLI_assert(BLI_thread_is_main());
+  BLI_assert(memfile_shared_users > 0);
+
+  BLO_memfile_free(memfile_shared);
+  MEM_freeN(memfile_shared);
+
+  memfile_shared_users--;
+  if (memfile_shared_users == 0) {
+    BLI_linklist_free(memfile_shared_deferred_bufs, MEM_freeN);
+    memfile_shared_deferred_bufs = NULL;
+  }
+}
+
 /* Clear is_identical_future before adding next memfile. */
 void BLO_memfile_clear_future(MemFile *memfile)
 {
@@ -113,6 +190,20 @@ void BLO_memfile_clear_future(MemFile *memfile)
   }
 }
 
+static uint memfile_chunk_content_hash(const void *key)
+{
+  const MemFileChunk *chunk = key;
+  return chunk->content_hash;
+}
+
+static bool memfile_chunk_content_cmp(const void *a, const void *b)
+{
+  const MemFileChunk *chunk_a = a;
+  const MemFileChunk *chunk_b = b;
+  return !((chunk_a->content_hash == chunk_b->content_hash) && (chunk_a->size == chunk_b->size) &&
+           (memcmp(chunk_a->buf, chunk_b->buf, chunk_a->size) == 0));
+}
+
 void BLO_memfile_write_init(MemFileWriteData *mem_data,
                             MemFile *written_memfile,
                             MemFile *reference_memfile)
@@ -129,8 +220,15 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   if (reference_memfile != NULL) {
     mem_data->id_session_uuid_mapping = BLI_ghash_new(
         BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
+    /* Chunks which don't match the reference at the same position can still share memory
+     * with any chunk of the reference that has the same content (e.g. when data moved
+     * between IDs, or an ID was duplicated). Since the reference memfile shares buffers
+     * with all previous steps, this de-duplicates against the whole undo stack. */
+    mem_data->reference_chunks_by_content = BLI_gset_new(
+        memfile_chunk_content_hash, memfile_chunk_content_cmp, __func__);
     uint current_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
     LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &reference_memfile->chunks) {
+      BLI_gset_add(mem_data->reference_chunks_by_content, mem_chunk);
       if (!ELEM(mem_chunk->id_session_uuid, MAIN_ID_SESSION_UUID_UNSET, current_session_uuid)) {
         current_session_uuid = mem_chunk->id_session_uuid;
         void **entry;
@@ -152,6 +250,9 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->reference_chunks_by_content != NULL) {
+    BLI_gset_free(mem_data->reference_chunks_by_content, NULL);
+  }
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint size)
@@ -163,6 +264,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint siz
   curchunk->size = size;
   curchunk->buf = NULL;
   curchunk->is_identical = false;
+  curchunk->is_deduplicated = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
@@ -177,12 +279,32 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint siz
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
+        curchunk->content_hash = compchunk->content_hash;
         compchunk->is_identical_future = true;
       }
     }
     *compchunk_step = compchunk->next;
   }
 
+  /* Not equal to the chunk at the same position, look for the same content elsewhere. */
+  if (curchunk->buf == NULL) {
+    curchunk->content_hash = BLI_hash_mm2((const uchar *)buf, size, 0);
+
+    if (mem_data->reference_chunks_by_content != NULL) {
+      const MemFileChunk chunk_key = {
+          .buf = buf,
+          .size = size,
+          .content_hash = curchunk->content_hash,
+      };
+      const MemFileChunk *dupchunk = BLI_gset_lookup(mem_data->reference_chunks_by_content,
+                                                     &chunk_key);
+      if (dupchunk != NULL) {
+        curchunk->buf = dupchunk->buf;
+        curchunk->is_deduplicated = true;
+      }
+    }
+  }
+
   /* not equal... */
   if (curchunk->buf == NULL) {
     char *buf_new = MEM_mallocN(size, "Chunk buffer");
@@ -149,7 +149,10 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"  // MEM_freeN
+#include "atomic_ops.h"
 
 #include "BKE_action.h"
 #include "BKE_armature.h"
@@ -224,7 +227,7 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    struct ZLibWriter *zlib_writer;
   } _user_data;
 };
 
@@ -255,16 +258,173 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 #undef FILE_HANDLE
 
 /* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+
+/**
+ * Compressed files are written as a sequence of independent gzip members,
+ * each holding #ZLIB_CHUNK_SIZE bytes of uncompressed data.
+ * Concatenated gzip members are a valid gzip stream (readable by `gzread` and older versions),
+ * while the members can be compressed on multiple threads.
+ */
+#define ZLIB_CHUNK_SIZE (1 << 20) /* 1mb */
+/* Compression level, matches the previous "wb1" mode used for `gzopen`. */
+#define ZLIB_CHUNK_LEVEL 1
+
+/** #ZLibChunk.state, a chunk is compressed by whichever thread claims it first. */
+enum {
+  ZLIB_CHUNK_QUEUED = 0,
+  ZLIB_CHUNK_RUNNING = 1,
+  ZLIB_CHUNK_DONE = 2,
+};
+
+typedef struct ZLibChunk {
+  struct ZLibChunk *next, *prev;
+  /** Uncompressed input data, #ZLIB_CHUNK_SIZE bytes. */
+  char *in_buf;
+  size_t in_len;
+  /** Compressed gzip member. */
+  char *out_buf;
+  size_t out_len;
+  bool error;
+  int32_t state;
+} ZLibChunk;
+
+typedef struct ZLibWriter {
+  int file_handle;
+  TaskPool *task_pool;
+  /** Chunks that are queued for compression, written to the file in order. */
+  ListBase chunks;
+  int chunks_len;
+  /**
+   * Chunks that were written, their task may still have to run and find out it has nothing
+   * to do. Only freed once the task pool is done.
+   */
+  ListBase chunks_written;
+  /** Maximum number of chunks in flight, bounds memory usage. */
+  int chunks_max;
+  /** Chunk currently being filled. */
+  ZLibChunk *chunk_active;
+  /** Signaled when a chunk is done, to wake up the thread writing the oldest chunk. */
+  ThreadMutex done_mutex;
+  ThreadCondition done_cond;
+  bool error;
+} ZLibWriter;
+
+#define FILE_HANDLE(ww) (ww)->_user_data.zlib_writer
+
+static void ww_zlib_chunk_compress_do(ZLibChunk *chunk)
+{
+  z_stream strm = {NULL};
+
+  /* `16 + MAX_WBITS` writes a gzip header and footer around the deflate stream. */
+  if (deflateInit2(&strm, ZLIB_CHUNK_LEVEL, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) !=
+      Z_OK) {
+    chunk->error = true;
+    return;
+  }
+
+  const uLong out_len_max = deflateBound(&strm, (uLong)chunk->in_len);
+  chunk->out_buf = MEM_mallocN(out_len_max, __func__);
+
+  strm.next_in = (Bytef *)chunk->in_buf;
+  strm.avail_in = (uInt)chunk->in_len;
+  strm.next_out = (Bytef *)chunk->out_buf;
+  strm.avail_out = (uInt)out_len_max;
+
+  if (deflate(&strm, Z_FINISH) != Z_STREAM_END) {
+    chunk->error = true;
+  }
+  chunk->out_len = strm.total_out;
+
+  deflateEnd(&strm);
+
+  /* The input isn't needed anymore, free it early to reduce peak memory. */
+  MEM_freeN(chunk->in_buf);
+  chunk->in_buf = NULL;
+}
+
+static void ww_zlib_chunk_compress(TaskPool *__restrict pool, void *taskdata)
+{
+  ZLibWriter *writer = BLI_task_pool_user_data(pool);
+  ZLibChunk *chunk = taskdata;
+
+  /* The writing thread may already have compressed the chunk itself. */
+  if (atomic_cas_int32(&chunk->state, ZLIB_CHUNK_QUEUED, ZLIB_CHUNK_RUNNING) !=
+      ZLIB_CHUNK_QUEUED) {
+    return;
+  }
+
+  ww_zlib_chunk_compress_do(chunk);
+
+  BLI_mutex_lock(&writer->done_mutex);
+  atomic_cas_int32(&chunk->state, ZLIB_CHUNK_RUNNING, ZLIB_CHUNK_DONE);
+  BLI_condition_notify_all(&writer->done_cond);
+  BLI_mutex_unlock(&writer->done_mutex);
+}
+
+/**
+ * Write the oldest queued chunk to the file, the others keep being compressed meanwhile.
+ * When no thread started on that chunk yet, it's compressed here rather than waiting for it.
+ */
+static void ww_zlib_write_oldest(ZLibWriter *writer)
+{
+  ZLibChunk *chunk = writer->chunks.first;
+
+  if (atomic_cas_int32(&chunk->state, ZLIB_CHUNK_QUEUED, ZLIB_CHUNK_RUNNING) ==
+      ZLIB_CHUNK_QUEUED) {
+    ww_zlib_chunk_compress_do(chunk);
+  }
+  else {
+    BLI_mutex_lock(&writer->done_mutex);
+    while (atomic_add_and_fetch_int32(&chunk->state, 0) != ZLIB_CHUNK_DONE) {
+      BLI_condition_wait(&writer->done_cond, &writer->done_mutex);
+    }
+    BLI_mutex_unlock(&writer->done_mutex);
+  }
+
+  if (chunk->error) {
+    writer->error = true;
+  }
+  if (!writer->error) {
+    if ((size_t)write(writer->file_handle, chunk->out_buf, chunk->out_len) != chunk->out_len) {
+      writer->error = true;
+    }
+  }
+
+  BLI_remlink(&writer->chunks, chunk);
+  writer->chunks_len--;
+  MEM_SAFE_FREE(chunk->in_buf);
+  MEM_SAFE_FREE(chunk->out_buf);
+  BLI_addtail(&writer->chunks_written, chunk);
+}
+
+static void ww_zlib_chunk_push(ZLibWriter *writer)
+{
+  ZLibChunk *chunk = writer->chunk_active;
+  writer->chunk_active = NULL;
+
+  BLI_addtail(&writer->chunks, chunk);
+  writer->chunks_len++;
+  BLI_task_pool_push(writer->task_pool, ww_zlib_chunk_compress, chunk, false, NULL);
+
+  if (writer->chunks_len >= writer->chunks_max) {
+    ww_zlib_write_oldest(writer);
+  }
+}
 
 static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 {
-  gzFile file;
+  int file;
 
-  file = BLI_gzopen(filepath, "wb1");
+  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
+  if (file != -1) {
+    ZLibWriter *writer = MEM_callocN(sizeof(*writer), __func__);
+    writer->file_handle = file;
+    writer->task_pool = BLI_task_pool_create(writer, TASK_PRIORITY_HIGH);
+    writer->chunks_max = MAX2(2, BLI_task_scheduler_num_threads() * 2);
+    BLI_mutex_init(&writer->done_mutex);
+    BLI_condition_init(&writer->done_cond);
+    FILE_HANDLE(ww) = writer;
     return true;
   }
 
@@ -272,11 +432,58 @@ static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  ZLibWriter *writer = FILE_HANDLE(ww);
+
+  if (writer->chunk_active) {
+    ww_zlib_chunk_push(writer);
+  }
+  while (writer->chunks.first) {
+    ww_zlib_write_oldest(writer);
+  }
+
+  /* Tasks of chunks compressed by this thread may still have to run. */
+  BLI_task_pool_work_and_wait(writer->task_pool);
+  BLI_task_pool_free(writer->task_pool);
+  BLI_freelistN(&writer->chunks_written);
+  BLI_condition_end(&writer->done_cond);
+  BLI_mutex_end(&writer->done_mutex);
+
+  bool ok = !writer->error;
+  if (close(writer->file_handle) == -1) {
+    ok = false;
+  }
+  MEM_freeN(writer);
+
+  return ok;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  ZLibWriter *writer = FILE_HANDLE(ww);
+  size_t buf_offset = 0;
+
+  while (buf_offset < buf_len) {
+    if (writer->error) {
+      return 0;
+    }
+
+    ZLibChunk *chunk = writer->chunk_active;
+    if (chunk == NULL) {
+      chunk = MEM_callocN(sizeof(*chunk), __func__);
+      chunk->in_buf = MEM_mallocN(ZLIB_CHUNK_SIZE, __func__);
+      writer->chunk_active = chunk;
+    }
+
+    const size_t len = MIN2(buf_len - buf_offset, ZLIB_CHUNK_SIZE - chunk->in_len);
+    memcpy(chunk->in_buf + chunk->in_len, buf + buf_offset, len);
+    chunk->in_len += len;
+    buf_offset += len;
+
+    if (chunk->in_len == ZLIB_CHUNK_SIZE) {
+      ww_zlib_chunk_push(writer);
+    }
+  }
+
+  return buf_len;
 }
 #undef FILE_HANDLE
 
@@ -4461,9 +4668,12 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
 
-  ww.close(&ww);
+  /* Compressed data may only be written out on close. */
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -32,6 +32,7 @@ extern "C" {
 #endif
 
 struct Depsgraph;
+struct ID;
 struct Scene;
 struct ViewLayer;
 
@@ -52,6 +53,30 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+/* ------------------------------------------------ */
+/* Evaluation Timing
+ *
+ * All times are in seconds and averaged over recent evaluations. The evaluation time is always
+ * gathered, critical path, per operation and data-block times only when enabled with
+ * #DEG_stats_enable (or with `--debug-depsgraph-time`). */
+
+typedef struct DEGStatsOperation {
+  /* Original data-block the operation belongs to. */
+  struct ID *id;
+  /* Data-block, component and operation name. */
+  char identifier[256];
+  /* Time spent on the operation per evaluation. */
+  double time;
+} DEGStatsOperation;
+
+void DEG_stats_enable(struct Depsgraph *graph, bool enable);
+int DEG_stats_operations_slowest(const struct Depsgraph *graph,
+                                 DEGStatsOperation *r_operations,
+                                 int operations_len);
+double DEG_stats_id_time(const struct Depsgraph *graph, const struct ID *id);
+double DEG_stats_evaluation_time(const struct Depsgraph *graph);
+double DEG_stats_critical_path_time(const struct Depsgraph *graph);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
@@ -116,6 +116,8 @@ void AbstractBuilderPipeline::build_step_finalize()
 #endif
   /* Relations are up to date. */
   deg_graph_->need_update = false;
+  /* Operations were created again, without any timing. */
+  deg_graph_->critical_path_costs_valid = false;
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
@@ -36,7 +36,10 @@ namespace blender {
 namespace deg {
 
 DepsgraphDebug::DepsgraphDebug()
-    : flags(G.debug), is_ever_evaluated(false), graph_evaluation_start_time_(0)
+    : flags(G.debug),
+      is_ever_evaluated(false),
+      stats_enabled(false),
+      graph_evaluation_start_time_(0)
 {
 }
 
@@ -45,15 +48,16 @@ bool DepsgraphDebug::do_time_debug() const
   return ((G.debug & G_DEBUG_DEPSGRAPH_TIME) != 0);
 }
 
-void DepsgraphDebug::begin_graph_evaluation()
+bool DepsgraphDebug::do_stats() const
 {
-  if (!do_time_debug()) {
-    return;
-  }
+  return stats_enabled || do_time_debug();
+}
 
+void DepsgraphDebug::begin_graph_evaluation()
+{
   const double current_time = PIL_check_seconds_timer();
 
-  if (is_ever_evaluated) {
+  if (do_time_debug() && is_ever_evaluated) {
     fps_samples_.add_sample(current_time - graph_evaluation_start_time_);
   }
 
@@ -62,17 +66,33 @@ void DepsgraphDebug::begin_graph_evaluation()
 
 void DepsgraphDebug::end_graph_evaluation()
 {
-  if (!do_time_debug()) {
-    return;
-  }
-
   const double graph_eval_end_time = PIL_check_seconds_timer();
-  printf("Depsgraph updated in %f seconds.\n", graph_eval_end_time - graph_evaluation_start_time_);
-  printf("Depsgraph evaluation FPS: %f\n", 1.0f / fps_samples_.get_averaged());
+  evaluation_time_samples_.add_sample(graph_eval_end_time - graph_evaluation_start_time_);
+
+  if (do_time_debug()) {
+    printf("Depsgraph updated in %f seconds.\n",
+           graph_eval_end_time - graph_evaluation_start_time_);
+    printf("Depsgraph evaluation FPS: %f\n", 1.0f / fps_samples_.get_averaged());
+  }
 
   is_ever_evaluated = true;
 }
 
+void DepsgraphDebug::add_critical_path_time(double time)
+{
+  critical_path_time_samples_.add_sample(time);
+}
+
+double DepsgraphDebug::get_average_evaluation_time() const
+{
+  return evaluation_time_samples_.get_averaged();
+}
+
+double DepsgraphDebug::get_average_critical_path_time() const
+{
+  return critical_path_time_samples_.get_averaged();
+}
+
 bool terminal_do_color(void)
 {
   return (G.debug & G_DEBUG_DEPSGRAPH_PRETTY) != 0;
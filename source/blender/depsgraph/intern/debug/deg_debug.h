@@ -38,10 +38,20 @@ class DepsgraphDebug {
   DepsgraphDebug();
 
   bool do_time_debug() const;
+  /* Whether operation timing is gathered into the per-node statistics, see DEG_stats_enable(). */
+  bool do_stats() const;
 
   void begin_graph_evaluation();
   void end_graph_evaluation();
 
+  /* Time spent on the longest chain of operations evaluated by the current update. */
+  void add_critical_path_time(double time);
+
+  /* Timing averaged over recent graph evaluations. The evaluation time is gathered even when
+   * time debug is disabled, the critical path time only with the per-node statistics. */
+  double get_average_evaluation_time() const;
+  double get_average_critical_path_time() const;
+
   /* NOTE: Corresponds to G_DEBUG_DEPSGRAPH_* flags. */
   int flags;
 
@@ -53,9 +63,14 @@ class DepsgraphDebug {
    * This is NOT an indication that depsgraph is at its evaluated state. */
   bool is_ever_evaluated;
 
+  /* Per-node statistics were requested with DEG_stats_enable(). */
+  bool stats_enabled;
+
  protected:
   /* Maximum number of counters used to calculate frame rate of depsgraph update. */
   static const constexpr int MAX_FPS_COUNTERS = 64;
+  /* Number of recent evaluations used for the averaged evaluation timing. */
+  static const constexpr int MAX_PROFILE_SAMPLES = 16;
 
   /* Point in time when last graph evaluation began.
    * Is initialized from begin_graph_evaluation() when time debug is enabled.
@@ -63,6 +78,9 @@ class DepsgraphDebug {
   double graph_evaluation_start_time_;
 
   AveragedTimeSampler<MAX_FPS_COUNTERS> fps_samples_;
+
+  AveragedTimeSampler<MAX_PROFILE_SAMPLES> evaluation_time_samples_;
+  AveragedTimeSampler<MAX_PROFILE_SAMPLES> critical_path_time_samples_;
 };
 
 #define DEG_DEBUG_PRINTF(depsgraph, type, ...) \
@@ -72,6 +72,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       scene_cow(nullptr),
       is_active(false),
       is_evaluating(false),
+      critical_path_costs_valid(false),
       is_render_pipeline_depsgraph(false)
 {
   BLI_spin_init(&lock);
@@ -161,6 +161,11 @@ struct Depsgraph {
 
   bool is_evaluating;
 
+  /* Critical path costs of the operations, used to order their evaluation. They are kept until
+   * the relations are rebuilt or the cost of an operation changes noticeably, see
+   * deg_eval_critical_path_costs_calculate(). */
+  bool critical_path_costs_valid;
+
   /* Is set to truth for dependency graph which are used for post-processing (compositor and
    * sequencer).
    * Such dependency graph needs all view layers (so render pipeline can access names), but it
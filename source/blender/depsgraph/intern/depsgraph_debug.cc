@@ -23,6 +23,9 @@
  * Implementation of tools for debugging the depsgraph
  */
 
+#include <algorithm>
+
+#include "BLI_string.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_scene_types.h"
@@ -40,6 +43,7 @@
 #include "intern/depsgraph_type.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
 
 namespace deg = blender::deg;
@@ -245,6 +249,86 @@ void DEG_stats_simple(const Depsgraph *graph,
   }
 }
 
+/**
+ * Gather the time spent on every operation, for #DEG_stats_operations_slowest and
+ * #DEG_stats_id_time. Starts with the next evaluation of the graph.
+ */
+void DEG_stats_enable(Depsgraph *graph, bool enable)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  deg_graph->debug.stats_enabled = enable;
+}
+
+/**
+ * Fill \a r_operations with the operations which took the most time to evaluate,
+ * slowest first.
+ * \return The number of operations written, at most \a operations_len.
+ */
+int DEG_stats_operations_slowest(const Depsgraph *graph,
+                                 DEGStatsOperation *r_operations,
+                                 int operations_len)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+
+  blender::Vector<const deg::OperationNode *> op_nodes;
+  for (const deg::OperationNode *op_node : deg_graph->operations) {
+    if (op_node->stats.average_time > 0.0) {
+      op_nodes.append(op_node);
+    }
+  }
+  const int len = std::min(operations_len, (int)op_nodes.size());
+  std::partial_sort(op_nodes.begin(),
+                    op_nodes.begin() + len,
+                    op_nodes.end(),
+                    [](const deg::OperationNode *a, const deg::OperationNode *b) {
+                      return a->stats.average_time > b->stats.average_time;
+                    });
+
+  for (int i = 0; i < len; i++) {
+    const deg::OperationNode *op_node = op_nodes[i];
+    DEGStatsOperation *operation = &r_operations[i];
+    operation->id = op_node->owner->owner->id_orig;
+    BLI_strncpy(operation->identifier,
+                op_node->full_identifier().c_str(),
+                sizeof(operation->identifier));
+    operation->time = op_node->stats.average_time;
+  }
+  return len;
+}
+
+/**
+ * Time spent evaluating all operations of the data-block, zero when it is not in the graph.
+ */
+double DEG_stats_id_time(const Depsgraph *graph, const ID *id)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  const deg::IDNode *id_node = deg_graph->find_id_node(DEG_get_original_id((ID *)id));
+  if (id_node == nullptr) {
+    return 0.0;
+  }
+  return id_node->stats.average_time;
+}
+
+/**
+ * Wall-clock time of graph evaluation.
+ */
+double DEG_stats_evaluation_time(const Depsgraph *graph)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  return deg_graph->debug.get_average_evaluation_time();
+}
+
+/**
+ * Time needed to evaluate the longest chain of dependent operations per update, this is the lower
+ * limit of the evaluation time no matter how many threads are used. Only gathered when enabled
+ * with #DEG_stats_enable.
+ */
+double DEG_stats_critical_path_time(const Depsgraph *graph)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  return deg_graph->debug.get_average_critical_path_time();
+}
+
 static deg::string depsgraph_name_for_logging(struct Depsgraph *depsgraph)
 {
   const char *name = DEG_debug_name_get(depsgraph);
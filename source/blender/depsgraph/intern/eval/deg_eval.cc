@@ -57,6 +57,11 @@
 namespace blender {
 namespace deg {
 
+/* The cost of an operation has to change by this factor of the cost used for the critical paths,
+ * and at least by the minimum (in seconds), for the critical paths to be calculated again. */
+static constexpr float COST_DRIFT_FACTOR = 0.5f;
+static constexpr float COST_DRIFT_MIN = 5e-5f;
+
 namespace {
 
 struct DepsgraphEvalState;
@@ -74,6 +79,23 @@ void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), Tas
   BLI_task_pool_push(pool, deg_task_run_func, node, false, NULL);
 }
 
+/* Keep the child with the longest remaining path to be evaluated by the current task, so that
+ * expensive chains of operations are not delayed by waiting for a free thread. */
+void schedule_node_to_pool_or_continue(OperationNode *node,
+                                       const int thread_id,
+                                       TaskPool *pool,
+                                       OperationNode **r_next_node)
+{
+  if (*r_next_node == nullptr) {
+    *r_next_node = node;
+    return;
+  }
+  if (node->critical_path_cost > (*r_next_node)->critical_path_cost) {
+    std::swap(node, *r_next_node);
+  }
+  schedule_node_to_pool(node, thread_id, pool);
+}
+
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -96,22 +118,29 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Operations which are ready when the evaluation of a stage starts, sorted by their critical
+   * path cost. Every initial task claims the next one, see deg_task_run_ready_func(). */
+  Vector<OperationNode *> ready_nodes;
+  uint32_t ready_nodes_claimed;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
-  ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
+  Depsgraph *graph = state->graph;
+  ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(graph);
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double evaluation_time = PIL_check_seconds_timer() - start_time;
   if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    operation_node->stats.current_time += evaluation_time;
   }
-  else {
-    operation_node->evaluate(depsgraph);
+  if (deg_eval_operation_cost_update(operation_node, evaluation_time) &&
+      graph->critical_path_costs_valid) {
+    atomic_fetch_and_and_uint8((uint8_t *)&graph->critical_path_costs_valid, (uint8_t) false);
   }
 }
 
@@ -120,12 +149,28 @@ void deg_task_run_func(TaskPool *pool, void *taskdata)
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
   OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  while (operation_node != nullptr) {
+    /* Evaluate node. */
+    evaluate_node(state, operation_node);
 
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+    /* Schedule children, continue with the most expensive one which became ready. */
+    OperationNode *next_node = nullptr;
+    schedule_children(state, operation_node, schedule_node_to_pool_or_continue, pool, &next_node);
+    operation_node = next_node;
+  }
+}
+
+/* Initial task of a stage. Tasks aren't necessarily started in the order they were pushed (the
+ * thread waiting for the pool runs its own tasks last-in first-out, other threads steal the
+ * oldest ones), so rather than being bound to an operation, every task takes the most expensive
+ * operation which wasn't taken yet. */
+void deg_task_run_ready_func(TaskPool *pool, void *UNUSED(taskdata))
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  const uint32_t index = atomic_fetch_and_add_uint32(&state->ready_nodes_claimed, 1);
+  BLI_assert(index < state->ready_nodes.size());
+  deg_task_run_func(pool, state->ready_nodes[index]);
 }
 
 bool check_operation_node_visible(OperationNode *op_node)
@@ -182,9 +227,15 @@ void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  /* Calculated again after the relations were rebuilt, or when the cost of an operation changed
+   * noticeably since the last calculation. */
+  if (!graph->critical_path_costs_valid) {
+    deg_eval_critical_path_costs_calculate(graph->operations);
+    graph->critical_path_costs_valid = true;
+  }
   /* Clear tags and other things which needs to be clear. */
-  for (OperationNode *node : graph->operations) {
-    if (do_stats) {
+  if (do_stats) {
+    for (OperationNode *node : graph->operations) {
       node->stats.reset_current();
     }
   }
@@ -307,6 +358,26 @@ void schedule_children(DepsgraphEvalState *state,
   }
 }
 
+void schedule_node_to_vector(OperationNode *node,
+                             const int /*thread_id*/,
+                             Vector<OperationNode *> *nodes)
+{
+  nodes->append(node);
+}
+
+/* Start evaluation of the operations which are ready from the one with the longest remaining path,
+ * see deg_task_run_ready_func(). */
+void schedule_graph_to_pool(DepsgraphEvalState *state, TaskPool *pool)
+{
+  state->ready_nodes.clear();
+  state->ready_nodes_claimed = 0;
+  schedule_graph(state, schedule_node_to_vector, &state->ready_nodes);
+  deg_eval_sort_by_critical_path(state->ready_nodes);
+  for (int64_t i = 0; i < state->ready_nodes.size(); i++) {
+    BLI_task_pool_push(pool, deg_task_run_ready_func, nullptr, false, nullptr);
+  }
+}
+
 void schedule_node_to_queue(OperationNode *node,
                             const int /*thread_id*/,
                             GSQueue *evaluation_queue)
@@ -348,6 +419,129 @@ void depsgraph_ensure_view_layer(Depsgraph *graph)
 
 }  // namespace
 
+/* Smooth out the cost over recent evaluations, timing of a single evaluation is noisy.
+ * Returns true when the cost drifted away from the one the critical path costs were calculated
+ * with, so that the order of evaluation is outdated. Small changes are ignored, so noise in the
+ * timing doesn't cause the critical paths to be calculated again on every update. */
+bool deg_eval_operation_cost_update(OperationNode *node, const double evaluation_time)
+{
+  if (node->evaluation_cost == 0.0f) {
+    node->evaluation_cost = (float)evaluation_time;
+  }
+  else {
+    node->evaluation_cost = 0.75f * node->evaluation_cost + 0.25f * (float)evaluation_time;
+  }
+  const float cost_used = node->critical_path_evaluation_cost;
+  const float cost_drift = std::abs(node->evaluation_cost - cost_used);
+  return cost_drift > std::max(COST_DRIFT_MIN, COST_DRIFT_FACTOR * cost_used);
+}
+
+/* Calculate critical path cost of all visible operations, walking from the operations nothing
+ * depends on towards the roots of the graph. Operations which are part of a dependency cycle only
+ * get their own cost. All visible operations are included, not only the ones tagged for update,
+ * so the result can be reused until an operation cost changes, see
+ * deg_eval_operation_cost_update().
+ * Returns the cost of the longest chain of operations in the graph. */
+float deg_eval_critical_path_costs_calculate(Span<OperationNode *> operations)
+{
+  float critical_path_cost = 0.0f;
+  Vector<OperationNode *> stack;
+  for (OperationNode *node : operations) {
+    node->critical_path_cost = node->evaluation_cost;
+    node->critical_path_evaluation_cost = node->evaluation_cost;
+    node->num_children_pending = 0;
+    if (!check_operation_node_visible(node)) {
+      continue;
+    }
+    for (Relation *rel : node->outlinks) {
+      OperationNode *child = (OperationNode *)rel->to;
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && check_operation_node_visible(child)) {
+        ++node->num_children_pending;
+      }
+    }
+    if (node->num_children_pending == 0) {
+      stack.append(node);
+    }
+  }
+
+  while (!stack.is_empty()) {
+    OperationNode *node = stack.pop_last();
+    critical_path_cost = std::max(critical_path_cost, node->critical_path_cost);
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC)) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      if (!check_operation_node_visible(parent)) {
+        continue;
+      }
+      parent->critical_path_cost = std::max(parent->critical_path_cost,
+                                            parent->evaluation_cost + node->critical_path_cost);
+      if (--parent->num_children_pending == 0) {
+        stack.append(parent);
+      }
+    }
+  }
+  return critical_path_cost;
+}
+
+/* Time spent on the longest chain of operations evaluated in the current update, from their
+ * #Node::Stats::current_time. Operations which were not scheduled are not part of the chain. */
+double deg_eval_critical_path_time(Span<OperationNode *> operations)
+{
+  Map<const OperationNode *, double> path_times;
+  Vector<OperationNode *> stack;
+  for (OperationNode *node : operations) {
+    if (!node->scheduled) {
+      continue;
+    }
+    node->num_children_pending = 0;
+    for (Relation *rel : node->outlinks) {
+      const OperationNode *child = (OperationNode *)rel->to;
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && child->scheduled) {
+        ++node->num_children_pending;
+      }
+    }
+    path_times.add_new(node, node->stats.current_time);
+    if (node->num_children_pending == 0) {
+      stack.append(node);
+    }
+  }
+
+  double critical_path_time = 0.0;
+  while (!stack.is_empty()) {
+    OperationNode *node = stack.pop_last();
+    const double path_time = path_times.lookup(node);
+    critical_path_time = std::max(critical_path_time, path_time);
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC)) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      if (!parent->scheduled) {
+        continue;
+      }
+      double &parent_path_time = path_times.lookup(parent);
+      parent_path_time = std::max(parent_path_time, parent->stats.current_time + path_time);
+      if (--parent->num_children_pending == 0) {
+        stack.append(parent);
+      }
+    }
+  }
+  return critical_path_time;
+}
+
+/* Order operations which are ready to be evaluated, the one with the longest remaining path
+ * first. */
+void deg_eval_sort_by_critical_path(MutableSpan<OperationNode *> operations)
+{
+  std::stable_sort(operations.begin(),
+                   operations.end(),
+                   [](const OperationNode *a, const OperationNode *b) {
+                     return a->critical_path_cost > b->critical_path_cost;
+                   });
+}
+
 static TaskPool *deg_evaluate_task_pool_create(DepsgraphEvalState *state)
 {
   if (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) {
@@ -378,7 +572,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* Set up evaluation state. */
   DepsgraphEvalState state;
   state.graph = graph;
-  state.do_stats = graph->debug.do_time_debug();
+  state.do_stats = graph->debug.do_stats();
   state.need_single_thread_pass = false;
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
@@ -387,14 +581,14 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* First, process all Copy-On-Write nodes. */
   state.stage = EvaluationStage::COPY_ON_WRITE;
   TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
+  schedule_graph_to_pool(&state, task_pool);
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
   task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
+  schedule_graph_to_pool(&state, task_pool);
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
@@ -407,6 +601,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
   if (state.do_stats) {
+    graph->debug.add_critical_path_time(deg_eval_critical_path_time(graph->operations));
     deg_eval_stats_aggregate(graph);
   }
   /* Clear any uncleared tags - just in case. */
@@ -25,10 +25,13 @@
 
 #pragma once
 
+#include "BLI_span.hh"
+
 namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /**
  * Evaluate all nodes tagged for updating,
@@ -39,5 +42,11 @@ struct Depsgraph;
  */
 void deg_evaluate_on_refresh(Depsgraph *graph);
 
+/* Evaluation order of the operations, operations on the longest chain are evaluated first. */
+bool deg_eval_operation_cost_update(OperationNode *node, const double evaluation_time);
+float deg_eval_critical_path_costs_calculate(Span<OperationNode *> operations);
+void deg_eval_sort_by_critical_path(MutableSpan<OperationNode *> operations);
+double deg_eval_critical_path_time(Span<OperationNode *> operations);
+
 }  // namespace deg
 }  // namespace blender
@@ -52,6 +52,14 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
     IDNode *id_node = comp_node->owner;
     id_node->stats.current_time += op_node->stats.current_time;
     comp_node->stats.current_time += op_node->stats.current_time;
+    op_node->stats.accumulate_current();
+  }
+  for (Node *node : graph->id_nodes) {
+    IDNode *id_node = (IDNode *)node;
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      comp_node->stats.accumulate_current();
+    }
+    id_node->stats.accumulate_current();
   }
 }
 
@@ -28,7 +28,8 @@ namespace deg {
 
 struct Depsgraph;
 
-/* Aggregate operation timings to overall component and ID nodes timing. */
+/* Aggregate operation timings to overall component and ID nodes timing,
+ * and fold the timing of all nodes into their averaged time. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
 }  // namespace deg
@@ -0,0 +1,174 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/eval/deg_eval.h"
+
+#include "BLI_vector.hh"
+
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_operation.h"
+
+#include "testing/testing.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+/* Visible operations which only have the fields used for ordering the evaluation. */
+class deg_eval_critical_path : public testing::Test {
+ protected:
+  ComponentNode component_;
+  Vector<OperationNode *> operations_;
+
+  void SetUp() override
+  {
+    component_.type = NodeType::GEOMETRY;
+    component_.affects_directly_visible = true;
+  }
+
+  void TearDown() override
+  {
+    for (OperationNode *node : operations_) {
+      delete node;
+    }
+  }
+
+  /* Chain of operations, each one depending on the previous one. Returns the first one. */
+  OperationNode *add_chain(const int length)
+  {
+    OperationNode *prev = nullptr;
+    OperationNode *first = nullptr;
+    for (int i = 0; i < length; i++) {
+      OperationNode *node = new OperationNode();
+      node->type = NodeType::OPERATION;
+      node->owner = &component_;
+      operations_.append(node);
+      if (prev != nullptr) {
+        new Relation(prev, node, "chain");
+      }
+      else {
+        first = node;
+      }
+      prev = node;
+    }
+    return first;
+  }
+
+  /* Time every operation of the chain starting at \a node, returns true when the critical path
+   * costs became outdated. */
+  static bool evaluate_chain(OperationNode *node, const double time)
+  {
+    bool costs_outdated = false;
+    while (node != nullptr) {
+      costs_outdated |= deg_eval_operation_cost_update(node, time);
+      node = node->outlinks.is_empty() ? nullptr : (OperationNode *)node->outlinks[0]->to;
+    }
+    return costs_outdated;
+  }
+
+  static OperationNode *first_ready(OperationNode *a, OperationNode *b)
+  {
+    Vector<OperationNode *> ready = {a, b};
+    deg_eval_sort_by_critical_path(ready);
+    return ready[0];
+  }
+};
+
+TEST_F(deg_eval_critical_path, Costs)
+{
+  OperationNode *a = add_chain(3);
+  OperationNode *b = add_chain(2);
+  EXPECT_TRUE(evaluate_chain(a, 1e-3));
+  EXPECT_TRUE(evaluate_chain(b, 2e-3));
+
+  EXPECT_FLOAT_EQ(deg_eval_critical_path_costs_calculate(operations_), 4e-3f);
+  EXPECT_FLOAT_EQ(a->critical_path_cost, 3e-3f);
+  EXPECT_FLOAT_EQ(b->critical_path_cost, 4e-3f);
+  EXPECT_EQ(first_ready(a, b), b);
+}
+
+TEST_F(deg_eval_critical_path, ChainBecomesHeavy)
+{
+  OperationNode *a = add_chain(3);
+  OperationNode *b = add_chain(3);
+
+  /* First evaluation, chain b is cheap. */
+  EXPECT_TRUE(evaluate_chain(a, 1e-3));
+  EXPECT_TRUE(evaluate_chain(b, 1e-4));
+  deg_eval_critical_path_costs_calculate(operations_);
+  EXPECT_EQ(first_ready(a, b), a);
+
+  /* Noise in the timing keeps the order. */
+  EXPECT_FALSE(evaluate_chain(a, 1.2e-3));
+  EXPECT_FALSE(evaluate_chain(b, 1.2e-4));
+
+  /* Chain b becomes heavy, which outdates the costs. */
+  EXPECT_FALSE(evaluate_chain(a, 1e-3));
+  EXPECT_TRUE(evaluate_chain(b, 1e-2));
+  deg_eval_critical_path_costs_calculate(operations_);
+  EXPECT_EQ(first_ready(a, b), b);
+  EXPECT_GT(b->critical_path_cost, a->critical_path_cost);
+
+  /* Further timing which confirms the new cost doesn't outdate the costs again. */
+  EXPECT_FALSE(evaluate_chain(b, 3e-3));
+}
+
+TEST_F(deg_eval_critical_path, NotEvaluatedBefore)
+{
+  OperationNode *a = add_chain(2);
+  OperationNode *b = add_chain(2);
+
+  /* Only chain a was evaluated when the costs were first calculated. */
+  EXPECT_TRUE(evaluate_chain(a, 1e-3));
+  deg_eval_critical_path_costs_calculate(operations_);
+  EXPECT_FLOAT_EQ(b->critical_path_cost, 0.0f);
+
+  EXPECT_TRUE(evaluate_chain(b, 5e-3));
+  deg_eval_critical_path_costs_calculate(operations_);
+  EXPECT_EQ(first_ready(a, b), b);
+}
+
+TEST_F(deg_eval_critical_path, Time)
+{
+  OperationNode *a = add_chain(3);
+  OperationNode *b = add_chain(2);
+  for (OperationNode *node : operations_) {
+    node->stats.current_time = (node == a) ? 3.0 : 1.0;
+    node->scheduled = true;
+  }
+  EXPECT_DOUBLE_EQ(deg_eval_critical_path_time(operations_), 5.0);
+
+  /* Only the operations evaluated by the update are part of the critical path. */
+  for (OperationNode *node : operations_) {
+    node->scheduled = false;
+  }
+  b->scheduled = true;
+  OperationNode *b_next = (OperationNode *)b->outlinks[0]->to;
+  b_next->scheduled = true;
+  EXPECT_DOUBLE_EQ(deg_eval_critical_path_time(operations_), 2.0);
+
+  a->scheduled = true;
+  EXPECT_DOUBLE_EQ(deg_eval_critical_path_time(operations_), 3.0);
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
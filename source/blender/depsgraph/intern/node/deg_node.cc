@@ -279,6 +279,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -286,6 +287,12 @@ void Node::Stats::reset_current()
   current_time = 0.0;
 }
 
+void Node::Stats::accumulate_current()
+{
+  /* Exponential moving average, roughly covering the last 8 evaluations. */
+  average_time += (current_time - average_time) * 0.125;
+}
+
 /*******************************************************************************
  * Node itself.
  */
@@ -210,7 +210,12 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode()
+    : evaluation_cost(0.0f),
+      critical_path_cost(0.0f),
+      critical_path_evaluation_cost(0.0f),
+      name_tag(-1),
+      flag(0)
 {
 }
 
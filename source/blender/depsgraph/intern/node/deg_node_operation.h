@@ -266,6 +266,16 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Time spent evaluating this operation, averaged over recent evaluations (in seconds). */
+  float evaluation_cost;
+  /* Cost of this operation and of the most expensive chain of operations which depends on it.
+   * Operations with the longest remaining chain are evaluated first. */
+  float critical_path_cost;
+  /* Evaluation cost the critical path costs were calculated with. */
+  float critical_path_evaluation_cost;
+  /* How many outlinks are we still waiting on before the critical path cost is known. */
+  uint32_t num_children_pending;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
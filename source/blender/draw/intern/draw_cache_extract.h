@@ -140,6 +140,11 @@ typedef struct MeshBufferCache {
     GPUIndexBuf *edituv_points;
     GPUIndexBuf *edituv_fdots;
   } ibo;
+  /* Indices of loose vertices and edges. Only need to be updated when topology changes. */
+  struct {
+    int *verts, *edges;
+    int vert_len, edge_len;
+  } loose_geom;
 } MeshBufferCache;
 
 typedef enum DRWBatchFlag {
@@ -256,7 +261,7 @@ typedef struct MeshBatchCache {
 
 void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                                         MeshBatchCache *cache,
-                                        MeshBufferCache mbc,
+                                        MeshBufferCache *mbc,
                                         Mesh *me,
                                         const bool is_editmode,
                                         const bool is_paint_mode,
@@ -132,83 +132,93 @@ typedef struct MeshRenderData {
   MLoopTri *mlooptri;
   float (*loop_normals)[3];
   float (*poly_normals)[3];
-  int *lverts, *ledges;
+  /** Owned by #MeshBufferCache.loose_geom. */
+  const int *lverts, *ledges;
 } MeshRenderData;
 
-static void mesh_render_data_update_loose_geom(MeshRenderData *mr,
-                                               const eMRIterType iter_type,
-                                               const eMRDataType UNUSED(data_flag))
+static void mesh_render_data_loose_geom_calc(const MeshRenderData *mr, MeshBufferCache *mbc)
 {
+  int *lverts, *ledges;
+  int vert_loose_len = 0, edge_loose_len = 0;
+
   if (mr->extract_type != MR_EXTRACT_BMESH) {
     /* Mesh */
-    if (iter_type & (MR_ITER_LEDGE | MR_ITER_LVERT)) {
-      mr->vert_loose_len = 0;
-      mr->edge_loose_len = 0;
-
-      BLI_bitmap *lvert_map = BLI_BITMAP_NEW(mr->vert_len, __func__);
+    BLI_bitmap *lvert_map = BLI_BITMAP_NEW(mr->vert_len, __func__);
 
-      mr->ledges = MEM_mallocN(mr->edge_len * sizeof(int), __func__);
-      const MEdge *med = mr->medge;
-      for (int med_index = 0; med_index < mr->edge_len; med_index++, med++) {
-        if (med->flag & ME_LOOSEEDGE) {
-          mr->ledges[mr->edge_loose_len++] = med_index;
-        }
-        /* Tag verts as not loose. */
-        BLI_BITMAP_ENABLE(lvert_map, med->v1);
-        BLI_BITMAP_ENABLE(lvert_map, med->v2);
-      }
-      if (mr->edge_loose_len < mr->edge_len) {
-        mr->ledges = MEM_reallocN(mr->ledges, mr->edge_loose_len * sizeof(*mr->ledges));
+    ledges = MEM_mallocN(mr->edge_len * sizeof(*ledges), __func__);
+    const MEdge *med = mr->medge;
+    for (int med_index = 0; med_index < mr->edge_len; med_index++, med++) {
+      if (med->flag & ME_LOOSEEDGE) {
+        ledges[edge_loose_len++] = med_index;
       }
+      /* Tag verts as not loose. */
+      BLI_BITMAP_ENABLE(lvert_map, med->v1);
+      BLI_BITMAP_ENABLE(lvert_map, med->v2);
+    }
 
-      mr->lverts = MEM_mallocN(mr->vert_len * sizeof(*mr->lverts), __func__);
-      for (int v = 0; v < mr->vert_len; v++) {
-        if (!BLI_BITMAP_TEST(lvert_map, v)) {
-          mr->lverts[mr->vert_loose_len++] = v;
-        }
+    lverts = MEM_mallocN(mr->vert_len * sizeof(*lverts), __func__);
+    for (int v = 0; v < mr->vert_len; v++) {
+      if (!BLI_BITMAP_TEST(lvert_map, v)) {
+        lverts[vert_loose_len++] = v;
       }
-      if (mr->vert_loose_len < mr->vert_len) {
-        mr->lverts = MEM_reallocN(mr->lverts, mr->vert_loose_len * sizeof(*mr->lverts));
-      }
-
-      MEM_freeN(lvert_map);
-
-      mr->loop_loose_len = mr->vert_loose_len + (mr->edge_loose_len * 2);
     }
+
+    MEM_freeN(lvert_map);
   }
   else {
     /* #BMesh */
     BMesh *bm = mr->bm;
-    if (iter_type & (MR_ITER_LEDGE | MR_ITER_LVERT)) {
-      int elem_id;
-      BMIter iter;
-      BMVert *eve;
-      BMEdge *ede;
-      mr->vert_loose_len = 0;
-      mr->edge_loose_len = 0;
-
-      mr->lverts = MEM_mallocN(mr->vert_len * sizeof(*mr->lverts), __func__);
-      BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, elem_id) {
-        if (eve->e == NULL) {
-          mr->lverts[mr->vert_loose_len++] = elem_id;
-        }
-      }
-      if (mr->vert_loose_len < mr->vert_len) {
-        mr->lverts = MEM_reallocN(mr->lverts, mr->vert_loose_len * sizeof(*mr->lverts));
-      }
+    int elem_id;
+    BMIter iter;
+    BMVert *eve;
+    BMEdge *ede;
 
-      mr->ledges = MEM_mallocN(mr->edge_len * sizeof(*mr->ledges), __func__);
-      BM_ITER_MESH_INDEX (ede, &iter, bm, BM_EDGES_OF_MESH, elem_id) {
-        if (ede->l == NULL) {
-          mr->ledges[mr->edge_loose_len++] = elem_id;
-        }
+    lverts = MEM_mallocN(mr->vert_len * sizeof(*lverts), __func__);
+    BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, elem_id) {
+      if (eve->e == NULL) {
+        lverts[vert_loose_len++] = elem_id;
       }
-      if (mr->edge_loose_len < mr->edge_len) {
-        mr->ledges = MEM_reallocN(mr->ledges, mr->edge_loose_len * sizeof(*mr->ledges));
+    }
+
+    ledges = MEM_mallocN(mr->edge_len * sizeof(*ledges), __func__);
+    BM_ITER_MESH_INDEX (ede, &iter, bm, BM_EDGES_OF_MESH, elem_id) {
+      if (ede->l == NULL) {
+        ledges[edge_loose_len++] = elem_id;
       }
+    }
+  }
+
+  if (vert_loose_len < mr->vert_len) {
+    lverts = MEM_reallocN(lverts, vert_loose_len * sizeof(*lverts));
+  }
+  if (edge_loose_len < mr->edge_len) {
+    ledges = MEM_reallocN(ledges, edge_loose_len * sizeof(*ledges));
+  }
 
-      mr->loop_loose_len = mr->vert_loose_len + mr->edge_loose_len * 2;
+  mbc->loose_geom.verts = lverts;
+  mbc->loose_geom.edges = ledges;
+  mbc->loose_geom.vert_len = vert_loose_len;
+  mbc->loose_geom.edge_len = edge_loose_len;
+}
+
+/**
+ * Loose geometry only depends on the topology, so it's stored in the buffer cache and reused
+ * until the cache is cleared, e.g. when only the vertex positions of a deformed mesh change.
+ */
+static void mesh_render_data_update_loose_geom(MeshRenderData *mr,
+                                               MeshBufferCache *mbc,
+                                               const eMRIterType iter_type,
+                                               const eMRDataType UNUSED(data_flag))
+{
+  if (iter_type & (MR_ITER_LEDGE | MR_ITER_LVERT)) {
+    if (mbc->loose_geom.verts == NULL) {
+      mesh_render_data_loose_geom_calc(mr, mbc);
     }
+    mr->lverts = mbc->loose_geom.verts;
+    mr->ledges = mbc->loose_geom.edges;
+    mr->vert_loose_len = mbc->loose_geom.vert_len;
+    mr->edge_loose_len = mbc->loose_geom.edge_len;
+    mr->loop_loose_len = mr->vert_loose_len + (mr->edge_loose_len * 2);
   }
 }
 
@@ -314,6 +324,7 @@ static void mesh_render_data_update_normals(MeshRenderData *mr,
 }
 
 static MeshRenderData *mesh_render_data_create(Mesh *me,
+                                               MeshBufferCache *mbc,
                                                const bool is_editmode,
                                                const bool is_paint_mode,
                                                const float obmat[4][4],
@@ -430,7 +441,7 @@ static MeshRenderData *mesh_render_data_create(Mesh *me,
     mr->poly_len = bm->totface;
     mr->tri_len = poly_to_tri_count(mr->poly_len, mr->loop_len);
   }
-  mesh_render_data_update_loose_geom(mr, iter_type, data_flag);
+  mesh_render_data_update_loose_geom(mr, mbc, iter_type, data_flag);
 
   return mr;
 }
@@ -441,9 +452,6 @@ static void mesh_render_data_free(MeshRenderData *mr)
   MEM_SAFE_FREE(mr->poly_normals);
   MEM_SAFE_FREE(mr->loop_normals);
 
-  MEM_SAFE_FREE(mr->lverts);
-  MEM_SAFE_FREE(mr->ledges);
-
   MEM_freeN(mr);
 }
 
@@ -5406,7 +5414,7 @@ static void extract_task_create(struct TaskGraph *task_graph,
 
 void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                                         MeshBatchCache *cache,
-                                        MeshBufferCache mbc,
+                                        MeshBufferCache *mbc,
                                         Mesh *me,
 
                                         const bool is_editmode,
@@ -5453,11 +5461,11 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
   eMRIterType iter_flag = 0;
   eMRDataType data_flag = 0;
 
-  const bool do_lines_loose_subbuffer = mbc.ibo.lines_loose != NULL;
+  const bool do_lines_loose_subbuffer = mbc->ibo.lines_loose != NULL;
 
 #define TEST_ASSIGN(type, type_lowercase, name) \
   do { \
-    if (DRW_TEST_ASSIGN_##type(mbc.type_lowercase.name)) { \
+    if (DRW_TEST_ASSIGN_##type(mbc->type_lowercase.name)) { \
       iter_flag |= mesh_extract_iter_type(&extract_##name); \
       data_flag |= extract_##name.data_flag; \
     } \
@@ -5508,6 +5516,7 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
 #endif
 
   MeshRenderData *mr = mesh_render_data_create(me,
+                                               mbc,
                                                is_editmode,
                                                is_paint_mode,
                                                obmat,
@@ -5526,7 +5535,8 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
   double rdata_end = PIL_check_seconds_timer();
 #endif
 
-  size_t counters_size = (sizeof(mbc) / sizeof(void *)) * sizeof(int32_t);
+  size_t counters_size = ((sizeof(mbc->vbo) + sizeof(mbc->ibo)) / sizeof(void *)) *
+                         sizeof(int32_t);
   int32_t *task_counters = MEM_callocN(counters_size, __func__);
   int counter_used = 0;
 
@@ -5541,7 +5551,7 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
       task_graph, user_data_init_task_data);
 
 #define EXTRACT(buf, name) \
-  if (mbc.buf.name) { \
+  if (mbc->buf.name) { \
     extract_task_create(task_graph, \
                         task_node_mesh_render_data, \
                         task_node_user_data_init, \
@@ -5550,7 +5560,7 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                         scene, \
                         mr, \
                         &extract_##name, \
-                        mbc.buf.name, \
+                        mbc->buf.name, \
                         &task_counters[counter_used++]); \
   } \
   ((void)0)
@@ -5579,7 +5589,7 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
   EXTRACT(vbo, skin_roots);
 
   EXTRACT(ibo, tris);
-  if (mbc.ibo.lines) {
+  if (mbc->ibo.lines) {
     /* When `lines` and `lines_loose` are requested, schedule lines extraction that also creates
      * the `lines_loose` sub-buffer. */
     const MeshExtract *lines_extractor = do_lines_loose_subbuffer ?
@@ -5593,7 +5603,7 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                         scene,
                         mr,
                         lines_extractor,
-                        mbc.ibo.lines,
+                        mbc->ibo.lines,
                         &task_counters[counter_used++]);
   }
   else {
@@ -554,6 +554,16 @@ static void mesh_batch_cache_discard_surface_batches(MeshBatchCache *cache)
   cache->batch_ready &= ~MBC_SURFACE;
 }
 
+static void mesh_batch_cache_discard_batches(MeshBatchCache *cache)
+{
+  GPUBatch **batches = (GPUBatch **)&cache->batch;
+  for (int i = 0; i < sizeof(cache->batch) / sizeof(void *); i++) {
+    GPU_BATCH_DISCARD_SAFE(batches[i]);
+  }
+  mesh_batch_cache_discard_surface_batches(cache);
+  cache->batch_ready = 0;
+}
+
 static void mesh_batch_cache_discard_shaded_tri(MeshBatchCache *cache)
 {
   FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
@@ -691,6 +701,30 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, int mode)
       GPU_BATCH_DISCARD_SAFE(cache->batch.edituv_fdots);
       cache->batch_ready &= ~MBC_EDITUV;
       break;
+    case BKE_MESH_BATCH_DIRTY_DEFORM:
+      /* Only vertex positions changed: keep the index buffers, loose geometry and attributes like
+       * UV's and colors, only discard the buffers that depend on positions or normals.
+       *
+       * The triangles are discarded as well: n-gons are triangulated based on the vertex
+       * positions, the per material ranges of `ibo.tris` are owned by the surface batches which
+       * are discarded below, and the adjacency is built from the triangles. */
+      FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+        GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.tris);
+        GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.lines_adjacency);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.pos_nor);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.lnor);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edge_fac);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.tan);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.stretch_area);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.stretch_angle);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.mesh_analysis);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_pos);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_nor);
+        GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.skin_roots);
+      }
+      /* Almost every batch uses one of the buffers above. */
+      mesh_batch_cache_discard_batches(cache);
+      break;
     default:
       BLI_assert(0);
   }
@@ -711,6 +745,10 @@ static void mesh_batch_cache_clear(Mesh *me)
     for (int i = 0; i < sizeof(mbufcache->ibo) / sizeof(void *); i++) {
       GPU_INDEXBUF_DISCARD_SAFE(ibos[i]);
     }
+    MEM_SAFE_FREE(mbufcache->loose_geom.verts);
+    MEM_SAFE_FREE(mbufcache->loose_geom.edges);
+    mbufcache->loose_geom.vert_len = 0;
+    mbufcache->loose_geom.edge_len = 0;
   }
   for (int i = 0; i < sizeof(cache->batch) / sizeof(void *); i++) {
     GPUBatch **batch = (GPUBatch **)&cache->batch;
@@ -1503,7 +1541,7 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
   if (do_uvcage) {
     mesh_buffer_cache_create_requested(task_graph,
                                        cache,
-                                       cache->uv_cage,
+                                       &cache->uv_cage,
                                        me,
                                        is_editmode,
                                        is_paint_mode,
@@ -1520,7 +1558,7 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
   if (do_cage) {
     mesh_buffer_cache_create_requested(task_graph,
                                        cache,
-                                       cache->cage,
+                                       &cache->cage,
                                        me,
                                        is_editmode,
                                        is_paint_mode,
@@ -1536,7 +1574,7 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
 
   mesh_buffer_cache_create_requested(task_graph,
                                      cache,
-                                     cache->final,
+                                     &cache->final,
                                      me,
                                      is_editmode,
                                      is_paint_mode,
@@ -3040,10 +3040,10 @@ static int remove_doubles_exec(bContext *C, wmOperator *op)
   ParticleSystem *psys = edit->psys;
   ParticleSystemModifierData *psmd_eval;
   KDTree_3d *tree;
-  KDTreeNearest_3d nearest[10];
+  const uint nearest_len_capacity = 10;
   POINT_P;
-  float mat[4][4], co[3], threshold = RNA_float_get(op->ptr, "threshold");
-  int n, totn, removed, totremoved;
+  float mat[4][4], threshold = RNA_float_get(op->ptr, "threshold");
+  int n, removed, totremoved;
 
   if (psys->flag & PSYS_GLOBAL_HAIR) {
     return OPERATOR_CANCELLED;
@@ -3058,29 +3058,39 @@ static int remove_doubles_exec(bContext *C, wmOperator *op)
 
     tree = BLI_kdtree_3d_new(psys->totpart);
 
+    float(*cos)[3] = MEM_malloc_arrayN(edit->totpoint, sizeof(*cos), __func__);
+    int *cos_point = MEM_malloc_arrayN(edit->totpoint, sizeof(*cos_point), __func__);
+    int cos_len = 0;
+
     /* insert particles into kd tree */
     LOOP_SELECTED_POINTS {
       psys_mat_hair_to_object(
           ob, psmd_eval->mesh_final, psys->part->from, psys->particles + p, mat);
-      copy_v3_v3(co, point->keys->co);
-      mul_m4_v3(mat, co);
-      BLI_kdtree_3d_insert(tree, p, co);
+      copy_v3_v3(cos[cos_len], point->keys->co);
+      mul_m4_v3(mat, cos[cos_len]);
+      BLI_kdtree_3d_insert(tree, p, cos[cos_len]);
+      cos_point[cos_len] = p;
+      cos_len++;
     }
 
     BLI_kdtree_3d_balance(tree);
 
-    /* tag particles to be removed */
-    LOOP_SELECTED_POINTS {
-      psys_mat_hair_to_object(
-          ob, psmd_eval->mesh_final, psys->part->from, psys->particles + p, mat);
-      copy_v3_v3(co, point->keys->co);
-      mul_m4_v3(mat, co);
+    /* find the neighbors of all particles at once */
+    KDTreeNearest_3d *nearest = MEM_malloc_arrayN(
+        (size_t)cos_len * nearest_len_capacity, sizeof(*nearest), __func__);
+    int *nearest_len = MEM_malloc_arrayN(cos_len, sizeof(*nearest_len), __func__);
+    BLI_kdtree_3d_find_nearest_n_batch(
+        tree, cos, (uint)cos_len, nearest, nearest_len, nearest_len_capacity);
 
-      totn = BLI_kdtree_3d_find_nearest_n(tree, co, nearest, 10);
+    /* tag particles to be removed */
+    for (int i = 0; i < cos_len; i++) {
+      const KDTreeNearest_3d *point_nearest = &nearest[(uint)i * nearest_len_capacity];
+      p = cos_point[i];
+      point = &edit->points[p];
 
-      for (n = 0; n < totn; n++) {
+      for (n = 0; n < nearest_len[i]; n++) {
         /* this needs a custom threshold still */
-        if (nearest[n].index > p && nearest[n].dist < threshold) {
+        if (point_nearest[n].index > p && point_nearest[n].dist < threshold) {
           if (!(point->flag & PEP_TAG)) {
             point->flag |= PEP_TAG;
             removed++;
@@ -3090,6 +3100,10 @@ static int remove_doubles_exec(bContext *C, wmOperator *op)
     }
 
     BLI_kdtree_3d_free(tree);
+    MEM_freeN(cos);
+    MEM_freeN(cos_point);
+    MEM_freeN(nearest);
+    MEM_freeN(nearest_len);
 
     /* remove tagged particles - don't do mirror here! */
     remove_tagged_particles(ob, psys, 0);
@@ -26,6 +26,7 @@
 
 #include "intern/dna_utils.h"
 
+struct DNA_ReconstructInfo;
 struct SDNA;
 
 #ifdef __cplusplus
@@ -66,7 +67,7 @@ typedef enum eSDNA_Type {
 } eSDNA_Type;
 
 /**
- * For use with #DNA_struct_reconstruct & #DNA_struct_get_compareflags
+ * For use with #DNA_reconstruct_info_create & #DNA_struct_get_compareflags
  */
 enum eSDNA_StructCompare {
   /* Struct has disappeared
@@ -97,12 +98,20 @@ int DNA_struct_find_nr_ex(const struct SDNA *sdna, const char *str, unsigned int
 int DNA_struct_find_nr(const struct SDNA *sdna, const char *str);
 void DNA_struct_switch_endian(const struct SDNA *oldsdna, int oldSDNAnr, char *data);
 const char *DNA_struct_get_compareflags(const struct SDNA *sdna, const struct SDNA *newsdna);
-void *DNA_struct_reconstruct(const struct SDNA *newsdna,
-                             const struct SDNA *oldsdna,
-                             const char *compflags,
-                             int oldSDNAnr,
+struct DNA_ReconstructInfo *DNA_reconstruct_info_create(const struct SDNA *oldsdna,
+                                                        const struct SDNA *newsdna,
+                                                        const char *compare_flags);
+void DNA_reconstruct_info_free(struct DNA_ReconstructInfo *reconstruct_info);
+void *DNA_struct_reconstruct(const struct DNA_ReconstructInfo *reconstruct_info,
+                             int old_struct_nr,
                              int blocks,
-                             const void *data);
+                             const void *old_blocks);
+void DNA_struct_reconstruct_range(const struct DNA_ReconstructInfo *reconstruct_info,
+                                  int old_struct_nr,
+                                  int block_start,
+                                  int block_end,
+                                  const void *old_blocks,
+                                  void *new_blocks);
 
 int DNA_elem_offset(struct SDNA *sdna, const char *stype, const char *vartype, const char *name);
 
@@ -106,6 +106,9 @@ typedef struct Mesh_Runtime {
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
+  /** Hash of the mesh data for the modifier result cache, zero when not calculated yet. */
+  uint64_t modifier_cache_data_key;
+
   /** Set by modifier stack if only deformed from original. */
   char deformed_only;
   /**
@@ -125,7 +128,13 @@ typedef struct Mesh_Runtime {
    */
   char wrapper_type_finalize;
 
-  char _pad[4];
+  /**
+   * Set when the draw cache was taken over from the previous evaluated mesh,
+   * which only differs in its vertex positions. See #BKE_MESH_BATCH_DIRTY_DEFORM.
+   */
+  char batch_cache_deform_only;
+
+  char _pad[3];
 
   /** Needed in case we need to lazily initialize the mesh. */
   CustomData_MeshMasks cd_mask_extra;
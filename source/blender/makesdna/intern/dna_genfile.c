@@ -793,101 +793,95 @@ static eSDNA_Type sdna_type_nr(const char *dna_type)
 
 /**
  * Converts a value of one primitive type to another.
- * Note there is no optimization for the case where otype and ctype are the same:
+ * Note there is no optimization for the case where old_type and new_type are the same:
  * assumption is that caller will handle this case.
  *
- * \param ctype: Name of type to convert to
- * \param otype: Name of type to convert from
- * \param name_array_len: Result of #DNA_elem_array_size for this element.
- * \param curdata: Where to put converted data
- * \param olddata: Data of type otype to convert
+ * \param old_type: Type to convert from.
+ * \param new_type: Type to convert to.
+ * \param array_len: Number of elements to convert.
+ * \param old_data: Data of type old_type to convert.
+ * \param new_data: Where to put converted data.
  */
-static void cast_elem(
-    const char *ctype, const char *otype, int name_array_len, char *curdata, const char *olddata)
+static void cast_primitive_type(const eSDNA_Type old_type,
+                                const eSDNA_Type new_type,
+                                int array_len,
+                                const char *old_data,
+                                char *new_data)
 {
+  const int old_type_size = DNA_elem_type_size(old_type);
+  const int new_type_size = DNA_elem_type_size(new_type);
   double val = 0.0;
-  int curlen = 1, oldlen = 1;
 
-  eSDNA_Type ctypenr, otypenr;
-
-  if ((otypenr = sdna_type_nr(otype)) == -1 || (ctypenr = sdna_type_nr(ctype)) == -1) {
-    return;
-  }
-
-  /* define lengths */
-  oldlen = DNA_elem_type_size(otypenr);
-  curlen = DNA_elem_type_size(ctypenr);
-
-  while (name_array_len > 0) {
-    switch (otypenr) {
+  while (array_len > 0) {
+    switch (old_type) {
       case SDNA_TYPE_CHAR:
-        val = *olddata;
+        val = *old_data;
         break;
       case SDNA_TYPE_UCHAR:
-        val = *((unsigned char *)olddata);
+        val = *((unsigned char *)old_data);
         break;
       case SDNA_TYPE_SHORT:
-        val = *((short *)olddata);
+        val = *((short *)old_data);
         break;
       case SDNA_TYPE_USHORT:
-        val = *((unsigned short *)olddata);
+        val = *((unsigned short *)old_data);
         break;
       case SDNA_TYPE_INT:
-        val = *((int *)olddata);
+        val = *((int *)old_data);
         break;
       case SDNA_TYPE_FLOAT:
-        val = *((float *)olddata);
+        val = *((float *)old_data);
         break;
       case SDNA_TYPE_DOUBLE:
-        val = *((double *)olddata);
+        val = *((double *)old_data);
         break;
       case SDNA_TYPE_INT64:
-        val = *((int64_t *)olddata);
+        val = *((int64_t *)old_data);
         break;
       case SDNA_TYPE_UINT64:
-        val = *((uint64_t *)olddata);
+        val = *((uint64_t *)old_data);
         break;
     }
 
-    switch (ctypenr) {
+    switch (new_type) {
       case SDNA_TYPE_CHAR:
-        *curdata = val;
+        *new_data = val;
         break;
       case SDNA_TYPE_UCHAR:
-        *((unsigned char *)curdata) = val;
+        *((unsigned char *)new_data) = val;
         break;
       case SDNA_TYPE_SHORT:
-        *((short *)curdata) = val;
+        *((short *)new_data) = val;
         break;
       case SDNA_TYPE_USHORT:
-        *((unsigned short *)curdata) = val;
+        *((unsigned short *)new_data) = val;
         break;
       case SDNA_TYPE_INT:
-        *((int *)curdata) = val;
+        *((int *)new_data) = val;
         break;
       case SDNA_TYPE_FLOAT:
-        if (otypenr < 2) {
+        if (old_type < 2) {
           val /= 255;
         }
-        *((float *)curdata) = val;
+        *((float *)new_data) = val;
         break;
       case SDNA_TYPE_DOUBLE:
-        if (otypenr < 2) {
+        if (old_type < 2) {
           val /= 255;
         }
-        *((double *)curdata) = val;
+        *((double *)new_data) = val;
         break;
       case SDNA_TYPE_INT64:
-        *((int64_t *)curdata) = val;
+        *((int64_t *)new_data) = val;
         break;
       case SDNA_TYPE_UINT64:
-        *((uint64_t *)curdata) = val;
+        *((uint64_t *)new_data) = val;
         break;
     }
 
-    olddata += oldlen;
-    curdata += curlen;
-    name_array_len--;
+    old_data += old_type_size;
+    new_data += new_type_size;
+    array_len--;
   }
 }
 
@@ -895,42 +889,31 @@ static void cast_elem(
  * Converts pointer values between different sizes. These are only used
  * as lookup keys to identify data blocks in the saved .blend file, not
  * as actual in-memory pointers.
- *
- * \param curlen: Pointer length to convert to
- * \param oldlen: Length of pointers in olddata
- * \param name_array_len: Result of #DNA_elem_array_size for this element.
- * \param curdata: Where to put converted data
- * \param olddata: Data to convert
  */
-static void cast_pointer(
-    int curlen, int oldlen, int name_array_len, char *curdata, const char *olddata)
+static void cast_pointer_64_to_32(int array_len, const char *old_data, char *new_data)
 {
-  int64_t lval;
+  while (array_len > 0) {
+    const int64_t lval = *((int64_t *)old_data);
 
-  while (name_array_len > 0) {
+    /* WARNING: 32-bit Blender trying to load file saved by 64-bit Blender,
+     * pointers may lose uniqueness on truncation! (Hopefully this wont
+     * happen unless/until we ever get to multi-gigabyte .blend files...) */
+    *((int *)new_data) = lval >> 3;
 
-    if (curlen == oldlen) {
-      memcpy(curdata, olddata, curlen);
-    }
-    else if (curlen == 4 && oldlen == 8) {
-      lval = *((int64_t *)olddata);
+    old_data += 8;
+    new_data += 4;
+    array_len--;
+  }
+}
 
-      /* WARNING: 32-bit Blender trying to load file saved by 64-bit Blender,
-       * pointers may lose uniqueness on truncation! (Hopefully this wont
-       * happen unless/until we ever get to multi-gigabyte .blend files...) */
-      *((int *)curdata) = lval >> 3;
-    }
-    else if (curlen == 8 && oldlen == 4) {
-      *((int64_t *)curdata) = *((int *)olddata);
-    }
-    else {
-      /* for debug */
-      printf("errpr: illegal pointersize!\n");
-    }
+static void cast_pointer_32_to_64(int array_len, const char *old_data, char *new_data)
+{
+  while (array_len > 0) {
+    *((int64_t *)new_data) = *((int *)old_data);
 
-    olddata += oldlen;
-    curdata += curlen;
-    name_array_len--;
+    old_data += 4;
+    new_data += 8;
+    array_len--;
   }
 }
 
@@ -1076,227 +1059,6 @@ static const char *find_elem(const SDNA *sdna,
   return NULL;
 }
 
-/**
- * Converts the contents of a single field of a struct, of a non-struct type,
- * from \a oldsdna to \a newsdna format.
- *
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param type: current field type name
- * \param new_name_nr: current field name number.
- * \param curdata: put field data converted to newsdna here
- * \param old: pointer to struct info in oldsdna
- * \param olddata: struct contents laid out according to oldsdna
- */
-static void reconstruct_elem(const SDNA *newsdna,
-                             const SDNA *oldsdna,
-                             const char *type,
-                             const int new_name_nr,
-                             char *curdata,
-                             const short *old,
-                             const char *olddata)
-{
-  /* rules: test for NAME:
-   *      - name equal:
-   *          - cast type
-   *      - name partially equal (array differs)
-   *          - type equal: memcpy
-   *          - type cast (per element).
-   * (nzc 2-4-2001 I want the 'unsigned' bit to be parsed as well. Where
-   * can I force this?)
-   */
-  int a, elemcount, len, countpos, mul;
-  const char *otype, *oname, *cp;
-
-  /* is 'name' an array? */
-  const char *name = newsdna->names[new_name_nr];
-  cp = name;
-  countpos = 0;
-  while (*cp && *cp != '[') {
-    cp++;
-    countpos++;
-  }
-  if (*cp != '[') {
-    countpos = 0;
-  }
-
-  /* in old is the old struct */
-  elemcount = old[1];
-  old += 2;
-  for (a = 0; a < elemcount; a++, old += 2) {
-    const int old_name_nr = old[1];
-    otype = oldsdna->types[old[0]];
-    oname = oldsdna->names[old[1]];
-    len = DNA_elem_size_nr(oldsdna, old[0], old[1]);
-
-    if (STREQ(name, oname)) { /* name equal */
-
-      if (ispointer(name)) { /* pointer of functionpointer afhandelen */
-        cast_pointer(newsdna->pointer_size,
-                     oldsdna->pointer_size,
-                     newsdna->names_array_len[new_name_nr],
-                     curdata,
-                     olddata);
-      }
-      else if (STREQ(type, otype)) { /* type equal */
-        memcpy(curdata, olddata, len);
-      }
-      else {
-        cast_elem(type, otype, newsdna->names_array_len[new_name_nr], curdata, olddata);
-      }
-
-      return;
-    }
-    if (countpos != 0) { /* name is an array */
-
-      if (oname[countpos] == '[' && strncmp(name, oname, countpos) == 0) { /* basis equal */
-        const int new_name_array_len = newsdna->names_array_len[new_name_nr];
-        const int old_name_array_len = oldsdna->names_array_len[old_name_nr];
-        const int min_name_array_len = MIN2(new_name_array_len, old_name_array_len);
-
-        if (ispointer(name)) { /* handle pointer or functionpointer */
-          cast_pointer(
-              newsdna->pointer_size, oldsdna->pointer_size, min_name_array_len, curdata, olddata);
-        }
-        else if (STREQ(type, otype)) { /* type equal */
-          /* size of single old array element */
-          mul = len / old_name_array_len;
-          /* smaller of sizes of old and new arrays */
-          mul *= min_name_array_len;
-
-          memcpy(curdata, olddata, mul);
-
-          if (old_name_array_len > new_name_array_len && STREQ(type, "char")) {
-            /* string had to be truncated, ensure it's still null-terminated */
-            curdata[mul - 1] = '\0';
-          }
-        }
-        else {
-          cast_elem(type, otype, min_name_array_len, curdata, olddata);
-        }
-        return;
-      }
-    }
-    olddata += len;
-  }
-}
-
-/**
- * Converts the contents of an entire struct from oldsdna to newsdna format.
- *
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param compflags:
- *
- * Result from DNA_struct_get_compareflags to avoid needless conversions.
- * \param oldSDNAnr: Index of old struct definition in oldsdna
- * \param data: Struct contents laid out according to oldsdna
- * \param curSDNAnr: Index of current struct definition in newsdna
- * \param cur: Where to put converted struct contents
- */
-static void reconstruct_struct(const SDNA *newsdna,
-                               const SDNA *oldsdna,
-                               const char *compflags,
-
-                               int oldSDNAnr,
-                               const char *data,
-                               int curSDNAnr,
-                               char *cur)
-{
-  /* Recursive!
-   * Per element from cur_struct, read data from old_struct.
-   * If element is a struct, call recursive.
-   */
-  int a, elemcount, elen, eleno, mul, mulo, firststructtypenr;
-  const short *spo, *spc, *sppo;
-  const char *type;
-  const char *cpo;
-  char *cpc;
-  const char *name;
-
-  unsigned int oldsdna_index_last = UINT_MAX;
-  unsigned int cursdna_index_last = UINT_MAX;
-
-  if (oldSDNAnr == -1) {
-    return;
-  }
-  if (curSDNAnr == -1) {
-    return;
-  }
-
-  if (compflags[oldSDNAnr] == SDNA_CMP_EQUAL) {
-    /* if recursive: test for equal */
-    spo = oldsdna->structs[oldSDNAnr];
-    elen = oldsdna->types_size[spo[0]];
-    memcpy(cur, data, elen);
-
-    return;
-  }
-
-  firststructtypenr = *(newsdna->structs[0]);
-
-  spo = oldsdna->structs[oldSDNAnr];
-  spc = newsdna->structs[curSDNAnr];
-
-  elemcount = spc[1];
-
-  spc += 2;
-  cpc = cur;
-  for (a = 0; a < elemcount; a++, spc += 2) { /* convert each field */
-    type = newsdna->types[spc[0]];
-    name = newsdna->names[spc[1]];
-
-    elen = DNA_elem_size_nr(newsdna, spc[0], spc[1]);
-
-    /* Skip pad bytes which must start with '_pad', see makesdna.c 'is_name_legal'.
-     * for exact rules. Note that if we fail to skip a pad byte it's harmless,
-     * this just avoids unnecessary reconstruction. */
-    if (name[0] == '_' || (name[0] == '*' && name[1] == '_')) {
-      cpc += elen;
-    }
-    else if (spc[0] >= firststructtypenr && !ispointer(name)) {
-      /* struct field type */
-
-      /* where does the old struct data start (and is there an old one?) */
-      cpo = (char *)find_elem(oldsdna, type, name, spo, data, &sppo);
-
-      if (cpo) {
-        oldSDNAnr = DNA_struct_find_nr_ex(oldsdna, type, &oldsdna_index_last);
-        curSDNAnr = DNA_struct_find_nr_ex(newsdna, type, &cursdna_index_last);
-
-        /* array! */
-        mul = newsdna->names_array_len[spc[1]];
-        mulo = oldsdna->names_array_len[sppo[1]];
-
-        eleno = DNA_elem_size_nr(oldsdna, sppo[0], sppo[1]);
-
-        elen /= mul;
-        eleno /= mulo;
-
-        while (mul--) {
-          reconstruct_struct(newsdna, oldsdna, compflags, oldSDNAnr, cpo, curSDNAnr, cpc);
-          cpo += eleno;
-          cpc += elen;
-
-          /* new struct array larger than old */
-          mulo--;
-          if (mulo <= 0) {
-            break;
-          }
-        }
-      }
-      else {
-        cpc += elen; /* skip field no longer present */
-      }
-    }
-    else {
-      /* non-struct field type */
-      reconstruct_elem(newsdna, oldsdna, type, spc[1], cpc, spo, data);
-      cpc += elen;
-    }
-  }
-}
-
 /**
  * Does endian swapping on the fields of a struct value.
  *
@@ -1390,57 +1152,482 @@ void DNA_struct_switch_endian(const SDNA *oldsdna, int oldSDNAnr, char *data)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Struct Reconstruction
+ *
+ * Converting a struct from the file layout to the current layout requires matching every
+ * member of the current struct with a member of the old struct by name. Instead of doing
+ * these string compares for every struct instance, a flat list of steps is computed once
+ * per struct of the file, converting a struct then only has to run its steps.
+ * \{ */
+
+typedef enum eReconstructStepType {
+  RECONSTRUCT_STEP_MEMCPY,
+  RECONSTRUCT_STEP_CAST_PRIMITIVE,
+  RECONSTRUCT_STEP_CAST_POINTER_TO_32,
+  RECONSTRUCT_STEP_CAST_POINTER_TO_64,
+  RECONSTRUCT_STEP_SUBSTRUCT,
+} eReconstructStepType;
+
+typedef struct ReconstructStep {
+  eReconstructStepType type;
+  /** Offsets of the member within the old and the new struct. */
+  int old_offset;
+  int new_offset;
+  union {
+    struct {
+      int size;
+    } memcpy;
+    struct {
+      int array_len;
+      eSDNA_Type old_type;
+      eSDNA_Type new_type;
+    } cast_primitive;
+    struct {
+      int array_len;
+    } cast_pointer;
+    struct {
+      int array_len;
+      /** Index of the member struct in the old SDNA, its steps are run for every element. */
+      int old_struct_nr;
+      int old_struct_size;
+      int new_struct_size;
+    } substruct;
+  } data;
+} ReconstructStep;
+
+typedef struct DNA_ReconstructInfo {
+  const SDNA *oldsdna;
+  const SDNA *newsdna;
+
+  /** Arrays with an element for every struct in the old SDNA. */
+  int *new_struct_nrs;
+  int *step_counts;
+  ReconstructStep **steps;
+
+  /** Storage of all steps. */
+  MemArena *memarena;
+} DNA_ReconstructInfo;
+
 /**
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param compflags:
+ * Computes the step that initializes a struct-typed member of the new struct.
+ * Returns false when the member is not present in the old struct.
+ */
+static bool reconstruct_step_init_substruct(const SDNA *oldsdna,
+                                            const SDNA *newsdna,
+                                            const char *compare_flags,
+                                            const short *old_struct,
+                                            const short *new_member,
+                                            ReconstructStep *r_step)
+{
+  const char *type = newsdna->types[new_member[0]];
+  const char *name = newsdna->names[new_member[1]];
+
+  /* Without array part, so names can differ. */
+  const short *old_member = NULL;
+  int old_offset = 0;
+  const short *sp = old_struct + 2;
+  for (int a = 0; a < old_struct[1]; a++, sp += 2) {
+    if (elem_streq(name, oldsdna->names[sp[1]])) {
+      if (STREQ(type, oldsdna->types[sp[0]])) {
+        old_member = sp;
+      }
+      break;
+    }
+    old_offset += DNA_elem_size_nr(oldsdna, sp[0], sp[1]);
+  }
+  if (old_member == NULL) {
+    return false;
+  }
+
+  const int old_struct_nr = DNA_struct_find_nr(oldsdna, type);
+  const int new_struct_nr = DNA_struct_find_nr(newsdna, type);
+  if (old_struct_nr == -1 || new_struct_nr == -1) {
+    return false;
+  }
+
+  const int array_len = MIN2(newsdna->names_array_len[new_member[1]],
+                             oldsdna->names_array_len[old_member[1]]);
+  const int old_struct_size = oldsdna->types_size[oldsdna->structs[old_struct_nr][0]];
+  const int new_struct_size = newsdna->types_size[newsdna->structs[new_struct_nr][0]];
+
+  r_step->old_offset = old_offset;
+  if (compare_flags[old_struct_nr] == SDNA_CMP_EQUAL) {
+    r_step->type = RECONSTRUCT_STEP_MEMCPY;
+    r_step->data.memcpy.size = old_struct_size * array_len;
+  }
+  else {
+    r_step->type = RECONSTRUCT_STEP_SUBSTRUCT;
+    r_step->data.substruct.array_len = array_len;
+    r_step->data.substruct.old_struct_nr = old_struct_nr;
+    r_step->data.substruct.old_struct_size = old_struct_size;
+    r_step->data.substruct.new_struct_size = new_struct_size;
+  }
+  return true;
+}
+
+/**
+ * Computes the step that initializes a member of the new struct that is a pointer or has a
+ * primitive type. Returns false when the member is not present in the old struct or its old
+ * value can't be converted.
  *
- * Result from DNA_struct_get_compareflags to avoid needless conversions
- * \param oldSDNAnr: Index of struct info within oldsdna
+ * Rules: test for NAME:
+ * - name equal:
+ *   - cast type
+ * - name partially equal (array differs)
+ *   - type equal: memcpy
+ *   - type cast (per element).
+ */
+static bool reconstruct_step_init_member(const SDNA *oldsdna,
+                                         const SDNA *newsdna,
+                                         const short *old_struct,
+                                         const short *new_member,
+                                         ReconstructStep *r_step)
+{
+  const char *type = newsdna->types[new_member[0]];
+  const char *name = newsdna->names[new_member[1]];
+  const int new_name_array_len = newsdna->names_array_len[new_member[1]];
+
+  /* Is 'name' an array? */
+  int countpos = 0;
+  const char *cp = name;
+  while (*cp && *cp != '[') {
+    cp++;
+    countpos++;
+  }
+  if (*cp != '[') {
+    countpos = 0;
+  }
+
+  const short *old_member = NULL;
+  int array_len = 0;
+  int old_offset = 0;
+  const short *sp = old_struct + 2;
+  for (int a = 0; a < old_struct[1]; a++, sp += 2) {
+    const char *oname = oldsdna->names[sp[1]];
+    if (STREQ(name, oname)) {
+      old_member = sp;
+      array_len = new_name_array_len;
+      break;
+    }
+    if (countpos != 0 && oname[countpos] == '[' && strncmp(name, oname, countpos) == 0) {
+      /* Basis equal. */
+      old_member = sp;
+      array_len = MIN2(new_name_array_len, oldsdna->names_array_len[sp[1]]);
+      break;
+    }
+    old_offset += DNA_elem_size_nr(oldsdna, sp[0], sp[1]);
+  }
+  if (old_member == NULL) {
+    return false;
+  }
+
+  const char *otype = oldsdna->types[old_member[0]];
+  r_step->old_offset = old_offset;
+
+  if (ispointer(name)) {
+    /* Handle pointer or function-pointer. */
+    if (newsdna->pointer_size == oldsdna->pointer_size) {
+      r_step->type = RECONSTRUCT_STEP_MEMCPY;
+      r_step->data.memcpy.size = newsdna->pointer_size * array_len;
+    }
+    else if (newsdna->pointer_size == 4 && oldsdna->pointer_size == 8) {
+      r_step->type = RECONSTRUCT_STEP_CAST_POINTER_TO_32;
+      r_step->data.cast_pointer.array_len = array_len;
+    }
+    else if (newsdna->pointer_size == 8 && oldsdna->pointer_size == 4) {
+      r_step->type = RECONSTRUCT_STEP_CAST_POINTER_TO_64;
+      r_step->data.cast_pointer.array_len = array_len;
+    }
+    else {
+      /* for debug */
+      printf("errpr: illegal pointersize!\n");
+      return false;
+    }
+  }
+  else if (STREQ(type, otype)) {
+    /* Size of a single old array element, times the smaller of the old and new array sizes. */
+    const int old_name_array_len = oldsdna->names_array_len[old_member[1]];
+    int size = DNA_elem_size_nr(oldsdna, old_member[0], old_member[1]) / old_name_array_len *
+               array_len;
+    if (old_name_array_len > new_name_array_len && STREQ(type, "char")) {
+      /* String had to be truncated, leave the last (zero initialized) character out
+       * so it's still null-terminated. */
+      size -= 1;
+    }
+    r_step->type = RECONSTRUCT_STEP_MEMCPY;
+    r_step->data.memcpy.size = size;
+  }
+  else {
+    const eSDNA_Type old_type = sdna_type_nr(otype);
+    const eSDNA_Type new_type = sdna_type_nr(type);
+    if (old_type == -1 || new_type == -1) {
+      return false;
+    }
+    r_step->type = RECONSTRUCT_STEP_CAST_PRIMITIVE;
+    r_step->data.cast_primitive.array_len = array_len;
+    r_step->data.cast_primitive.old_type = old_type;
+    r_step->data.cast_primitive.new_type = new_type;
+  }
+  return true;
+}
+
+/**
+ * Fills \a r_steps with the steps converting struct \a old_struct_nr to \a new_struct_nr,
+ * returns the number of steps, at most one per member of the new struct.
+ */
+static int reconstruct_steps_init(const SDNA *oldsdna,
+                                  const SDNA *newsdna,
+                                  const char *compare_flags,
+                                  const int old_struct_nr,
+                                  const int new_struct_nr,
+                                  ReconstructStep *r_steps)
+{
+  const short *old_struct = oldsdna->structs[old_struct_nr];
+  const short *new_struct = newsdna->structs[new_struct_nr];
+
+  if (compare_flags[old_struct_nr] == SDNA_CMP_EQUAL) {
+    r_steps[0].type = RECONSTRUCT_STEP_MEMCPY;
+    r_steps[0].old_offset = 0;
+    r_steps[0].new_offset = 0;
+    r_steps[0].data.memcpy.size = oldsdna->types_size[old_struct[0]];
+    return 1;
+  }
+
+  const int firststructtypenr = *(newsdna->structs[0]);
+  int step_count = 0;
+  int new_offset = 0;
+  const short *new_member = new_struct + 2;
+  for (int a = 0; a < new_struct[1]; a++, new_member += 2) {
+    const char *name = newsdna->names[new_member[1]];
+    const int new_member_size = DNA_elem_size_nr(newsdna, new_member[0], new_member[1]);
+
+    ReconstructStep *step = &r_steps[step_count];
+    bool has_step;
+
+    /* Skip pad bytes which must start with '_pad', see makesdna.c 'is_name_legal'.
+     * for exact rules. Note that if we fail to skip a pad byte it's harmless,
+     * this just avoids unnecessary reconstruction. */
+    if (name[0] == '_' || (name[0] == '*' && name[1] == '_')) {
+      has_step = false;
+    }
+    else if (new_member[0] >= firststructtypenr && !ispointer(name)) {
+      has_step = reconstruct_step_init_substruct(
+          oldsdna, newsdna, compare_flags, old_struct, new_member, step);
+    }
+    else {
+      has_step = reconstruct_step_init_member(oldsdna, newsdna, old_struct, new_member, step);
+    }
+
+    if (has_step) {
+      step->new_offset = new_offset;
+
+      /* Members that are copied unchanged are usually adjacent in both structs,
+       * merge them into a single copy. */
+      ReconstructStep *step_prev = (step_count > 0) ? &r_steps[step_count - 1] : NULL;
+      if (step_prev && step->type == RECONSTRUCT_STEP_MEMCPY &&
+          step_prev->type == RECONSTRUCT_STEP_MEMCPY &&
+          step_prev->old_offset + step_prev->data.memcpy.size == step->old_offset &&
+          step_prev->new_offset + step_prev->data.memcpy.size == step->new_offset) {
+        step_prev->data.memcpy.size += step->data.memcpy.size;
+      }
+      else if (step->type != RECONSTRUCT_STEP_MEMCPY || step->data.memcpy.size > 0) {
+        step_count++;
+      }
+    }
+    new_offset += new_member_size;
+  }
+  return step_count;
+}
+
+/**
+ * Computes the conversion steps for all structs in \a oldsdna that still exist in \a newsdna.
+ *
+ * \param oldsdna: SDNA of Blender that saved file.
+ * \param newsdna: SDNA of current Blender.
+ * \param compare_flags: Result from #DNA_struct_get_compareflags,
+ * used to avoid needless conversions.
+ */
+DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
+                                                 const SDNA *newsdna,
+                                                 const char *compare_flags)
+{
+  DNA_ReconstructInfo *reconstruct_info = MEM_callocN(sizeof(*reconstruct_info), __func__);
+  reconstruct_info->oldsdna = oldsdna;
+  reconstruct_info->newsdna = newsdna;
+  reconstruct_info->memarena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+
+  const int structs_len = oldsdna->structs_len;
+  reconstruct_info->new_struct_nrs = MEM_malloc_arrayN(structs_len, sizeof(int), __func__);
+  reconstruct_info->step_counts = MEM_calloc_arrayN(structs_len, sizeof(int), __func__);
+  reconstruct_info->steps = MEM_calloc_arrayN(structs_len, sizeof(ReconstructStep *), __func__);
+
+  /* Scratch space large enough for the steps of any struct. */
+  int members_len_max = 1;
+  for (int a = 0; a < newsdna->structs_len; a++) {
+    members_len_max = MAX2(members_len_max, newsdna->structs[a][1]);
+  }
+  ReconstructStep *steps_buf = MEM_malloc_arrayN(members_len_max, sizeof(*steps_buf), __func__);
+
+  unsigned int newsdna_index_last = 0;
+  for (int old_struct_nr = 0; old_struct_nr < structs_len; old_struct_nr++) {
+    const char *type = oldsdna->types[oldsdna->structs[old_struct_nr][0]];
+    const int new_struct_nr = DNA_struct_find_nr_ex(newsdna, type, &newsdna_index_last);
+    /* The next indices will almost always match. */
+    newsdna_index_last++;
+
+    reconstruct_info->new_struct_nrs[old_struct_nr] = new_struct_nr;
+    if (new_struct_nr == -1 || compare_flags[old_struct_nr] == SDNA_CMP_REMOVED) {
+      continue;
+    }
+
+    const int step_count = reconstruct_steps_init(
+        oldsdna, newsdna, compare_flags, old_struct_nr, new_struct_nr, steps_buf);
+    if (step_count > 0) {
+      const size_t steps_size = sizeof(*steps_buf) * (size_t)step_count;
+      ReconstructStep *steps = BLI_memarena_alloc(reconstruct_info->memarena, steps_size);
+      memcpy(steps, steps_buf, steps_size);
+      reconstruct_info->steps[old_struct_nr] = steps;
+      reconstruct_info->step_counts[old_struct_nr] = step_count;
+    }
+  }
+
+  MEM_freeN(steps_buf);
+
+  return reconstruct_info;
+}
+
+void DNA_reconstruct_info_free(DNA_ReconstructInfo *reconstruct_info)
+{
+  BLI_memarena_free(reconstruct_info->memarena);
+  MEM_freeN(reconstruct_info->new_struct_nrs);
+  MEM_freeN(reconstruct_info->step_counts);
+  MEM_freeN(reconstruct_info->steps);
+  MEM_freeN(reconstruct_info);
+}
+
+/**
+ * Converts the contents of an entire struct from oldsdna to newsdna format
+ * by running the steps computed for it.
+ *
+ * \param old_struct_nr: Index of old struct definition in oldsdna.
+ * \param old_data: Struct contents laid out according to oldsdna.
+ * \param new_data: Where to put converted struct contents, zero initialized.
+ */
+static void reconstruct_struct(const DNA_ReconstructInfo *reconstruct_info,
+                               const int old_struct_nr,
+                               const char *old_data,
+                               char *new_data)
+{
+  const ReconstructStep *steps = reconstruct_info->steps[old_struct_nr];
+  const int step_count = reconstruct_info->step_counts[old_struct_nr];
+
+  for (int a = 0; a < step_count; a++) {
+    const ReconstructStep *step = &steps[a];
+    const char *old_member = old_data + step->old_offset;
+    char *new_member = new_data + step->new_offset;
+
+    switch (step->type) {
+      case RECONSTRUCT_STEP_MEMCPY:
+        memcpy(new_member, old_member, step->data.memcpy.size);
+        break;
+      case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+        cast_primitive_type(step->data.cast_primitive.old_type,
+                            step->data.cast_primitive.new_type,
+                            step->data.cast_primitive.array_len,
+                            old_member,
+                            new_member);
+        break;
+      case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
+        cast_pointer_64_to_32(step->data.cast_pointer.array_len, old_member, new_member);
+        break;
+      case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+        cast_pointer_32_to_64(step->data.cast_pointer.array_len, old_member, new_member);
+        break;
+      case RECONSTRUCT_STEP_SUBSTRUCT:
+        for (int i = 0; i < step->data.substruct.array_len; i++) {
+          reconstruct_struct(reconstruct_info,
+                             step->data.substruct.old_struct_nr,
+                             old_member + i * step->data.substruct.old_struct_size,
+                             new_member + i * step->data.substruct.new_struct_size);
+        }
+        break;
+    }
+  }
+}
+
+/**
+ * \param reconstruct_info: Result from #DNA_reconstruct_info_create.
+ * \param old_struct_nr: Index of struct info within oldsdna
  * \param blocks: The number of array elements
- * \param data: Array of struct data
+ * \param old_blocks: Array of struct data
  * \return An allocated reconstructed struct
  */
-void *DNA_struct_reconstruct(const SDNA *newsdna,
-                             const SDNA *oldsdna,
-                             const char *compflags,
-                             int oldSDNAnr,
+void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
+                             int old_struct_nr,
                              int blocks,
-                             const void *data)
+                             const void *old_blocks)
 {
-  int a, curSDNAnr, curlen = 0, oldlen;
-  const short *spo, *spc;
-  char *cur, *cpc;
-  const char *cpo;
-  const char *type;
-
-  /* oldSDNAnr == structnr, we're looking for the corresponding 'cur' number */
-  spo = oldsdna->structs[oldSDNAnr];
-  type = oldsdna->types[spo[0]];
-  oldlen = oldsdna->types_size[spo[0]];
-  curSDNAnr = DNA_struct_find_nr(newsdna, type);
-
-  /* init data and alloc */
-  if (curSDNAnr != -1) {
-    spc = newsdna->structs[curSDNAnr];
-    curlen = newsdna->types_size[spc[0]];
-  }
-  if (curlen == 0) {
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+
+  /* old_struct_nr == structnr, we're looking for the corresponding 'cur' number */
+  const int new_struct_nr = reconstruct_info->new_struct_nrs[old_struct_nr];
+  if (new_struct_nr == -1) {
+    return NULL;
+  }
+  const int old_block_size = oldsdna->types_size[oldsdna->structs[old_struct_nr][0]];
+  const int new_block_size = newsdna->types_size[newsdna->structs[new_struct_nr][0]];
+  if (new_block_size == 0) {
     return NULL;
   }
 
-  cur = MEM_callocN(blocks * curlen, "reconstruct");
-  cpc = cur;
-  cpo = data;
-  for (a = 0; a < blocks; a++) {
-    reconstruct_struct(newsdna, oldsdna, compflags, oldSDNAnr, cpo, curSDNAnr, cpc);
-    cpc += curlen;
-    cpo += oldlen;
+  char *new_blocks = MEM_callocN((size_t)blocks * new_block_size, "reconstruct");
+  const char *old_data = old_blocks;
+  char *new_data = new_blocks;
+  for (int a = 0; a < blocks; a++) {
+    reconstruct_struct(reconstruct_info, old_struct_nr, old_data, new_data);
+    old_data += old_block_size;
+    new_data += new_block_size;
   }
 
-  return cur;
+  return new_blocks;
 }
 
+/**
+ * Same as #DNA_struct_reconstruct, but converts only the array elements in
+ * [\a block_start, \a block_end) into memory allocated by the caller.
+ * Different ranges of the same array can be converted from multiple threads.
+ *
+ * \param old_blocks: Array of struct data, laid out according to oldsdna.
+ * \param new_blocks: Zero initialized destination array, laid out according to newsdna.
+ */
+void DNA_struct_reconstruct_range(const DNA_ReconstructInfo *reconstruct_info,
+                                  int old_struct_nr,
+                                  int block_start,
+                                  int block_end,
+                                  const void *old_blocks,
+                                  void *new_blocks)
+{
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+  const int new_struct_nr = reconstruct_info->new_struct_nrs[old_struct_nr];
+  BLI_assert(new_struct_nr != -1);
+
+  const int old_block_size = oldsdna->types_size[oldsdna->structs[old_struct_nr][0]];
+  const int new_block_size = newsdna->types_size[newsdna->structs[new_struct_nr][0]];
+
+  const char *old_data = (const char *)old_blocks + (size_t)block_start * old_block_size;
+  char *new_data = (char *)new_blocks + (size_t)block_start * new_block_size;
+  for (int a = block_start; a < block_end; a++) {
+    reconstruct_struct(reconstruct_info, old_struct_nr, old_data, new_data);
+    old_data += old_block_size;
+    new_data += new_block_size;
+  }
+}
+
+/** \} */
+
 /**
  * Returns the offset of the field with the specified name and type within the specified
  * struct type in sdna.
@@ -18,6 +18,7 @@
  * \ingroup RNA
  */
 
+#include <float.h>
 #include <stdlib.h>
 
 #include "BLI_path_util.h"
@@ -267,6 +268,43 @@ static void rna_Depsgraph_debug_stats(Depsgraph *depsgraph, char *result)
                outer);
 }
 
+static void rna_Depsgraph_debug_stats_enable(Depsgraph *depsgraph, bool enable)
+{
+  DEG_stats_enable(depsgraph, enable);
+}
+
+static void rna_Depsgraph_debug_stats_operations(Depsgraph *depsgraph, int count, char *result)
+{
+  DEGStatsOperation *operations = MEM_malloc_arrayN(count, sizeof(*operations), __func__);
+  const int operations_len = DEG_stats_operations_slowest(depsgraph, operations, count);
+
+  size_t result_len = 0;
+  result[0] = '\0';
+  for (int i = 0; i < operations_len; i++) {
+    result_len += BLI_snprintf_rlen(result + result_len,
+                                    STATS_MAX_SIZE - result_len,
+                                    "%f %s\n",
+                                    operations[i].time,
+                                    operations[i].identifier);
+  }
+  MEM_freeN(operations);
+}
+
+static float rna_Depsgraph_debug_stats_id_time(Depsgraph *depsgraph, ID *id)
+{
+  return (float)DEG_stats_id_time(depsgraph, id);
+}
+
+static float rna_Depsgraph_debug_stats_evaluation_time(Depsgraph *depsgraph)
+{
+  return (float)DEG_stats_evaluation_time(depsgraph);
+}
+
+static float rna_Depsgraph_debug_stats_critical_path_time(Depsgraph *depsgraph)
+{
+  return (float)DEG_stats_critical_path_time(depsgraph);
+}
+
 static void rna_Depsgraph_update(Depsgraph *depsgraph, Main *bmain, ReportList *reports)
 {
   if (DEG_is_evaluating(depsgraph)) {
@@ -663,6 +701,49 @@ static void rna_def_depsgraph(BlenderRNA *brna)
   RNA_def_parameter_flags(parm, PROP_THICK_WRAP, 0); /* needed for string return value */
   RNA_def_function_output(func, parm);
 
+  func = RNA_def_function(srna, "debug_stats_enable", "rna_Depsgraph_debug_stats_enable");
+  RNA_def_function_ui_description(
+      func,
+      "Gather the time spent on every operation and data-block, starting with the next update");
+  parm = RNA_def_boolean(func, "enable", true, "Enable", "");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
+  func = RNA_def_function(
+      srna, "debug_stats_operations", "rna_Depsgraph_debug_stats_operations");
+  RNA_def_function_ui_description(
+      func,
+      "Report the operations which took the most time to evaluate, one per line, "
+      "as time in seconds followed by the operation name");
+  parm = RNA_def_int(
+      func, "count", 10, 1, 256, "Count", "Maximum number of operations to report", 1, 256);
+  /* weak!, no way to return dynamic string type */
+  parm = RNA_def_string(func, "result", NULL, STATS_MAX_SIZE, "result", "");
+  RNA_def_parameter_flags(parm, PROP_THICK_WRAP, 0); /* needed for string return value */
+  RNA_def_function_output(func, parm);
+
+  func = RNA_def_function(srna, "debug_stats_id_time", "rna_Depsgraph_debug_stats_id_time");
+  RNA_def_function_ui_description(
+      func, "Time spent evaluating the data-block per update, in seconds");
+  parm = RNA_def_pointer(func, "id", "ID", "", "Data-block to get evaluation time for");
+  RNA_def_parameter_flags(parm, PROP_NEVER_NULL, PARM_REQUIRED);
+  parm = RNA_def_float(func, "time", 0.0f, 0.0f, FLT_MAX, "Time", "", 0.0f, FLT_MAX);
+  RNA_def_function_return(func, parm);
+
+  func = RNA_def_function(
+      srna, "debug_stats_evaluation_time", "rna_Depsgraph_debug_stats_evaluation_time");
+  RNA_def_function_ui_description(func, "Time spent per update of the graph, in seconds");
+  parm = RNA_def_float(func, "time", 0.0f, 0.0f, FLT_MAX, "Time", "", 0.0f, FLT_MAX);
+  RNA_def_function_return(func, parm);
+
+  func = RNA_def_function(
+      srna, "debug_stats_critical_path_time", "rna_Depsgraph_debug_stats_critical_path_time");
+  RNA_def_function_ui_description(
+      func,
+      "Time needed to evaluate the longest chain of dependent operations per update, "
+      "in seconds (only gathered after debug_stats_enable)");
+  parm = RNA_def_float(func, "time", 0.0f, 0.0f, FLT_MAX, "Time", "", 0.0f, FLT_MAX);
+  RNA_def_function_return(func, parm);
+
   /* Updates. */
 
   func = RNA_def_function(srna, "update", "rna_Depsgraph_update");
@@ -39,7 +39,7 @@
 
 #include "BKE_action.h" /* BKE_pose_channel_find_name */
 #include "BKE_context.h"
-#include "BKE_customdata.h"
+#include "BKE_customdata.hh"
 #include "BKE_deform.h"
 #include "BKE_lib_query.h"
 #include "BKE_mesh.h"
@@ -95,7 +95,7 @@ static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphConte
 }
 
 /* A vertex will be in the mask if a selected bone influences it more than a certain threshold. */
-static void compute_vertex_mask__armature_mode(MDeformVert *dvert,
+static void compute_vertex_mask__armature_mode(Span<MDeformVert> dvert,
                                                Object *ob,
                                                Object *armature_ob,
                                                float threshold,
@@ -129,7 +129,7 @@ static void compute_vertex_mask__armature_mode(MDeformVert *dvert,
 }
 
 /* A vertex will be in the mask if the vertex group influences it more than a certain threshold. */
-static void compute_vertex_mask__vertex_group_mode(MDeformVert *dvert,
+static void compute_vertex_mask__vertex_group_mode(Span<MDeformVert> dvert,
                                                    int defgrp_index,
                                                    float threshold,
                                                    MutableSpan<bool> r_vertex_mask)
@@ -311,8 +311,9 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
   const bool invert_mask = mmd->flag & MOD_MASK_INV;
 
   /* Return empty or input mesh when there are no vertex groups. */
-  MDeformVert *dvert = (MDeformVert *)CustomData_get_layer(&mesh->vdata, CD_MDEFORMVERT);
-  if (dvert == NULL) {
+  const Span<MDeformVert> dvert = blender::bke::custom_data_layer_span<MDeformVert>(
+      mesh->vdata, CD_MDEFORMVERT, mesh->totvert);
+  if (dvert.is_empty()) {
     return invert_mask ? mesh : BKE_mesh_new_nomain_from_template(mesh, 0, 0, 0, 0, 0);
   }
 
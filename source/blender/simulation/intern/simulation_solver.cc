@@ -16,7 +16,7 @@
 
 #include "simulation_solver.hh"
 
-#include "BKE_customdata.h"
+#include "BKE_customdata.hh"
 #include "BKE_persistent_data_handle.hh"
 
 #include "BLI_rand.hh"
@@ -26,36 +26,6 @@
 
 namespace blender::sim {
 
-static CustomDataType cpp_to_custom_data_type(const CPPType &type)
-{
-  if (type.is<float3>()) {
-    return CD_PROP_FLOAT3;
-  }
-  if (type.is<float>()) {
-    return CD_PROP_FLOAT;
-  }
-  if (type.is<int32_t>()) {
-    return CD_PROP_INT32;
-  }
-  BLI_assert(false);
-  return CD_PROP_FLOAT;
-}
-
-static const CPPType &custom_to_cpp_data_type(CustomDataType type)
-{
-  switch (type) {
-    case CD_PROP_FLOAT3:
-      return CPPType::get<float3>();
-    case CD_PROP_FLOAT:
-      return CPPType::get<float>();
-    case CD_PROP_INT32:
-      return CPPType::get<int32_t>();
-    default:
-      BLI_assert(false);
-      return CPPType::get<float>();
-  }
-}
-
 class CustomDataAttributesRef {
  private:
   Array<void *> buffers_;
@@ -69,7 +39,7 @@ class CustomDataAttributesRef {
     for (int attribute_index : info.index_range()) {
       StringRefNull name = info.name_of(attribute_index);
       const CPPType &cpp_type = info.type_of(attribute_index);
-      CustomDataType custom_type = cpp_to_custom_data_type(cpp_type);
+      CustomDataType custom_type = bke::cpp_type_to_custom_data_type(cpp_type);
       void *data = CustomData_get_layer_named(&custom_data, custom_type, name.c_str());
       buffers_[attribute_index] = data;
     }
@@ -94,7 +64,7 @@ static void ensure_attributes_exist(ParticleSimulationState *state, const Attrib
     for (int layer_index = 0; layer_index < state->attributes.totlayer; layer_index++) {
       CustomDataLayer *layer = &state->attributes.layers[layer_index];
       BLI_assert(layer->name != nullptr);
-      const CPPType &cpp_type = custom_to_cpp_data_type((CustomDataType)layer->type);
+      const CPPType &cpp_type = *bke::custom_data_type_to_cpp_type((CustomDataType)layer->type);
       StringRefNull name = layer->name;
       if (!info.has_attribute(name, cpp_type)) {
         found_layer_to_remove = true;
@@ -107,7 +77,7 @@ static void ensure_attributes_exist(ParticleSimulationState *state, const Attrib
   for (int attribute_index : info.index_range()) {
     StringRefNull attribute_name = info.name_of(attribute_index);
     const CPPType &cpp_type = info.type_of(attribute_index);
-    CustomDataType custom_type = cpp_to_custom_data_type(cpp_type);
+    CustomDataType custom_type = bke::cpp_type_to_custom_data_type(cpp_type);
     if (CustomData_get_layer_named(&state->attributes, custom_type, attribute_name.c_str()) ==
         nullptr) {
       void *data = CustomData_add_layer_named(&state->attributes,
@@ -395,7 +365,7 @@ BLI_NOINLINE static void remove_dead_and_add_new_particles(ParticleSimulationSta
       dead_layer = &layer;
       continue;
     }
-    const CPPType &cpp_type = custom_to_cpp_data_type((CustomDataType)layer.type);
+    const CPPType &cpp_type = *bke::custom_data_type_to_cpp_type((CustomDataType)layer.type);
     GMutableSpan new_buffer{
         cpp_type,
         MEM_mallocN_aligned(new_particle_amount * cpp_type.size(), cpp_type.alignment(), AT),
@@ -1597,6 +1597,49 @@ void WM_autosave_init(wmWindowManager *wm)
   }
 }
 
+typedef struct AutosaveJob {
+  /** Shares the buffers of the undo memfile, see #BLO_memfile_share. */
+  struct MemFile *memfile;
+  char filepath[FILE_MAX];
+} AutosaveJob;
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     short *UNUSED(stop),
+                                     short *UNUSED(do_update),
+                                     float *UNUSED(progress))
+{
+  AutosaveJob *autosave_job = customdata;
+  /* Always finish writing, stopping half-way would leave a broken file behind. */
+  BLO_memfile_write_file(autosave_job->memfile, autosave_job->filepath);
+}
+
+static void wm_autosave_job_free(void *customdata)
+{
+  AutosaveJob *autosave_job = customdata;
+  BLO_memfile_share_release(autosave_job->memfile);
+  MEM_freeN(autosave_job);
+}
+
+/**
+ * Write the undo memfile from a job, so the disk IO doesn't block the user interface.
+ * The memory isn't copied, the job shares the buffers of the undo steps.
+ */
+static void wm_autosave_memfile_write_job(wmWindowManager *wm,
+                                          struct MemFile *memfile,
+                                          const char *filepath)
+{
+  AutosaveJob *autosave_job = MEM_callocN(sizeof(*autosave_job), __func__);
+  autosave_job->memfile = BLO_memfile_share(memfile);
+  BLI_strncpy(autosave_job->filepath, filepath, sizeof(autosave_job->filepath));
+
+  wmJob *wm_job = WM_jobs_get(wm, wm->winactive, wm, "Auto Save", 0, WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, autosave_job, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.1, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, NULL);
+
+  WM_jobs_start(wm, wm_job);
+}
+
 void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
 {
   char filepath[FILE_MAX];
@@ -1617,13 +1660,19 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
     }
   }
 
+  /* The previous auto-save is still being written, skip this one. */
+  if (WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE)) {
+    wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
+    return;
+  }
+
   wm_autosave_location(filepath);
 
   if (U.uiflag & USER_GLOBALUNDO) {
     /* fast save of last undobuffer, now with UI */
     struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
     if (memfile) {
-      BLO_memfile_write_file(memfile, filepath);
+      wm_autosave_memfile_write_job(wm, memfile, filepath);
     }
   }
   else {
@@ -527,6 +527,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--render-output");
   BLI_argsPrintArgDoc(ba, "--engine");
   BLI_argsPrintArgDoc(ba, "--threads");
+  BLI_argsPrintArgDoc(ba, "--threads-numa");
 
   printf("\n");
   printf("Format Options:\n");
@@ -1482,6 +1483,18 @@ static int arg_handle_threads_set(int argc, const char **argv, void *UNUSED(data
   }
 }
 
+static const char arg_handle_threads_numa_set_doc[] =
+    "\n"
+    "\tSpread worker threads over all NUMA nodes, instead of them running on the node of the\n"
+    "\tthread that started them.";
+static int arg_handle_threads_numa_set(int UNUSED(argc),
+                                       const char **UNUSED(argv),
+                                       void *UNUSED(data))
+{
+  BLI_system_numa_placement_set(true);
+  return 0;
+}
+
 static const char arg_handle_verbosity_set_doc[] =
     "<verbose>\n"
     "\tSet the logging verbosity level for debug messages that support it.";
@@ -2265,6 +2278,7 @@ void main_args_setup(bContext *C, bArgs *ba)
 
   BLI_argsAdd(ba, 4, "-F", "--render-format", CB(arg_handle_image_type_set), C);
   BLI_argsAdd(ba, 1, "-t", "--threads", CB(arg_handle_threads_set), NULL);
+  BLI_argsAdd(ba, 1, NULL, "--threads-numa", CB(arg_handle_threads_numa_set), NULL);
   BLI_argsAdd(ba, 4, "-x", "--use-extension", CB(arg_handle_extension_set), C);
 
 #  undef CB